@@ -19,6 +19,7 @@
 
 /* user includes */
 #include "adc.h"
+#include "cycle_counter.h"
 
 
 /* -- Macros
@@ -30,13 +31,91 @@
 /* Configuring pin for ADC: PF.6 */
 #define GPIOF_MODER_ANALOG (0x3 << 12)
 
+/* Sampling time of channel 4 in SMPR2 */
+#define ADC_SMPR2_CH4_SHIFT 12
+#define ADC_SMPR2_CH4_MASK  (0x7 << ADC_SMPR2_CH4_SHIFT)
+
+/* ADC control register 2 */
+#define ADC_CR2_ADON        (0x1 << 0)
+#define ADC_CR2_CONT        (0x1 << 1)
+#define ADC_CR2_DMA         (0x1 << 8)
+#define ADC_CR2_DDS         (0x1 << 9)      // DMA requests after last transfer
+#define ADC_CR2_EXTSEL_TRGO (0x6 << 24)     // external trigger: TIM2 TRGO
+#define ADC_CR2_EXTEN_RISE  (0x1 << 28)     // on rising edge
+#define ADC_CR2_SWSTART     (0x1 << 30)
+
+/* TIM2 as sample clock, clocked with 84 MHz */
+#define PERIPH_TIM2_ENABLE  (0x00000001)
+#define TIM2_CLOCK_HZ       84000000u
+#define TIM_CR1_CEN         (0x1 << 0)
+#define TIM_CR2_MMS_UPDATE  (0x2 << 4)      // TRGO on update event
+#define TIM_EGR_UG          (0x1 << 0)
+
+/* DMA2 stream 0 channel 2 is connected to ADC3 */
+#define PERIPH_DMA2_ENABLE  (0x00400000)
+#define DMA2_BASE           (0x40026400)
+#define DMA2_LISR           (*((volatile uint32_t *)(DMA2_BASE + 0x00)))
+#define DMA2_LIFCR          (*((volatile uint32_t *)(DMA2_BASE + 0x08)))
+#define DMA2_S0CR           (*((volatile uint32_t *)(DMA2_BASE + 0x10)))
+#define DMA2_S0NDTR         (*((volatile uint32_t *)(DMA2_BASE + 0x14)))
+#define DMA2_S0PAR          (*((volatile uint32_t *)(DMA2_BASE + 0x18)))
+#define DMA2_S0M0AR         (*((volatile uint32_t *)(DMA2_BASE + 0x1C)))
+#define DMA2_S0FCR          (*((volatile uint32_t *)(DMA2_BASE + 0x24)))
+
+#define DMA_S0_TEIF         (0x1 << 3)
+#define DMA_S0_HTIF         (0x1 << 4)
+#define DMA_S0_TCIF         (0x1 << 5)
+#define DMA_S0_ALL_FLAGS    (0x3D)
+
+#define DMA_CR_EN           (0x1 << 0)
+#define DMA_CR_ADC3         ((0x2 << 25)    /* CHSEL = 2 -> ADC3        */ \
+                           | (0x1 << 13)    /* MSIZE = 16 bit           */ \
+                           | (0x1 << 11)    /* PSIZE = 16 bit           */ \
+                           | (0x1 << 10)    /* MINC                     */ \
+                           | (0x1 << 8)     /* CIRC                     */ \
+                           | (0x1 << 4)     /* TCIE                     */ \
+                           | (0x1 << 3))    /* HTIE, DIR = periph -> mem */
+
+/* DMA2 stream 0 is IRQ 56 */
+#define NVIC_ISER1          (*((volatile uint32_t *)(0xE000E104)))
+#define NVIC_ICER1          (*((volatile uint32_t *)(0xE000E184)))
+#define IRQ_DMA2_STREAM0    (0x1 << (56 - 32))
+
+/* ADC1..3 share IRQ 18, only ADC3 enables EOCIE */
+#define NVIC_ISER0          (*((volatile uint32_t *)(0xE000E100)))
+#define IRQ_ADC             (0x1 << 18)
+#define ADC_CR1_EOCIE       (0x1 << 5)
+#define ADC_SR_EOC          (0x1 << 1)
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static uint16_t dma_buffer[2 * ADC_DMA_BLOCK_SIZE];
+static adc_block_callback_t block_callback = 0;
+static volatile uint32_t dma_samples = 0;
+static volatile uint32_t dma_busy_cycles = 0;
+static adc_async_t *volatile async_handle = 0;
+
+/* Instances timed by adc_avg_benchmark() */
+ADC_AVG_DEFINE(bench_avg_1, 0);
+ADC_AVG_DEFINE(bench_avg_16, 4);
+ADC_AVG_DEFINE(bench_avg_64, 6);
+ADC_AVG_DEFINE(bench_avg_256, 8);
+ADC_AVG_DEFINE(bench_avg_1024, 10);
+static adc_avg_t *const bench_avg[ADC_AVG_NR_OF_BENCH_LENGTHS] = {
+    &bench_avg_1, &bench_avg_16, &bench_avg_64, &bench_avg_256,
+    &bench_avg_1024
+};
+static uint16_t bench_output[ADC_AVG_BENCH_SAMPLES];
+
 
 /* -- Macros used by student code
  * ------------------------------------------------------------------------- */
 
 /// STUDENTS: To be programmed
-#define FILTER_LENGTH 16
-uint16_t adc_array[FILTER_LENGTH];
+#define FILTER_LENGTH_LOG2 4        // 16 samples
+ADC_AVG_DEFINE(adc_filter, FILTER_LENGTH_LOG2);
 /// END: To be programmed
 
 
@@ -77,10 +156,7 @@ void adc_init(void)
 		ADC3->SQR2 = 0x0;
 		ADC3->SQR3 = 0x4;
 		
-		
-		for(int i = 0; i < FILTER_LENGTH; i++){
-			adc_array[i] = 0x0;
-		}
+		adc_avg_reset(&adc_filter);
 
     /// END: To be programmed
 }
@@ -109,6 +185,16 @@ uint16_t adc_get_value(adc_resolution_t resolution)
 }
 
 
+/*
+ *  See header file
+ */
+void adc_set_sample_time(adc_sample_time_t sample_time)
+{
+    ADC3->SMPR2 = (ADC3->SMPR2 & ~ADC_SMPR2_CH4_MASK)
+                  | ((uint32_t)sample_time << ADC_SMPR2_CH4_SHIFT);
+}
+
+
 /*
  *  See header file
  */
@@ -117,16 +203,214 @@ uint16_t adc_filter_value(uint16_t adc_value)
     uint16_t filtered_value = 0;
 
     /// STUDENTS: To be programmed
-		uint32_t sum = 0;
-		for(int i = 0; i < FILTER_LENGTH-1; i++){
-				adc_array[i] = adc_array[i+1];
-				sum += adc_array[i+1];
-		}
-		adc_array[FILTER_LENGTH-1] = adc_value;
-		sum += adc_value;
-		
-		filtered_value = sum / FILTER_LENGTH;
+		filtered_value = adc_avg_update(&adc_filter, adc_value);
     /// END: To be programmed
 
     return filtered_value;
 }
+
+
+/*
+ *  See header file
+ */
+void adc_avg_reset(adc_avg_t *avg)
+{
+    uint16_t i;
+
+    for (i = 0; i <= avg->mask; i++) {
+        avg->buffer[i] = 0;
+    }
+    avg->index = 0;
+    avg->sum = 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_avg_update(adc_avg_t *avg, uint16_t adc_value)
+{
+    uint16_t index = avg->index;
+
+    /* 2^10 * 0xfff < 2^32 -> the running sum cannot overflow */
+    avg->sum += (uint32_t)adc_value - avg->buffer[index];
+    avg->buffer[index] = adc_value;
+    avg->index = (index + 1u) & avg->mask;
+
+    return (uint16_t)(avg->sum >> avg->shift);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_avg_benchmark(uint32_t cycles[ADC_AVG_NR_OF_BENCH_LENGTHS])
+{
+    uint32_t start;
+    uint16_t i;
+    uint8_t n;
+
+    for (n = 0; n < ADC_AVG_NR_OF_BENCH_LENGTHS; n++) {
+        adc_avg_reset(bench_avg[n]);
+        start = CYCLE_COUNTER;
+        for (i = 0; i < ADC_AVG_BENCH_SAMPLES; i++) {
+            bench_output[i] = adc_avg_update(bench_avg[n],
+                                             (uint16_t)((i * 37u) & 0xFFFu));
+        }
+        cycles[n] = (CYCLE_COUNTER - start) / ADC_AVG_BENCH_SAMPLES;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void adc_dma_start(adc_resolution_t resolution, uint32_t sample_rate_hz,
+                   adc_block_callback_t callback)
+{
+    adc_dma_stop();
+    block_callback = callback;
+
+    RCC->AHB1ENR |= PERIPH_DMA2_ENABLE;
+
+    /* Circular transfer over both blocks, IRQ after each block */
+    DMA2_LIFCR = DMA_S0_ALL_FLAGS;
+    DMA2_S0PAR = (uint32_t)&ADC3->DR;
+    DMA2_S0M0AR = (uint32_t)dma_buffer;
+    DMA2_S0NDTR = 2 * ADC_DMA_BLOCK_SIZE;
+    DMA2_S0FCR = 0;                             // direct mode, no FIFO
+    DMA2_S0CR = DMA_CR_ADC3;
+    DMA2_S0CR |= DMA_CR_EN;
+    NVIC_ISER1 = IRQ_DMA2_STREAM0;
+
+    ADC3->SR = 0;
+    ADC3->CR1 = resolution;
+
+    if (sample_rate_hz == ADC_RATE_CONTINUOUS) {
+        /* Continuous conversions, one DMA request per conversion */
+        ADC3->CR2 = ADC_CR2_ADON | ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS;
+        ADC3->CR2 |= ADC_CR2_SWSTART;
+    } else {
+        /* One conversion per TIM2 update event */
+        RCC->APB1ENR |= PERIPH_TIM2_ENABLE;
+        TIM2->CR1 = 0;
+        TIM2->PSC = 0;
+        TIM2->ARR = TIM2_CLOCK_HZ / sample_rate_hz - 1u;
+        TIM2->CR2 = TIM_CR2_MMS_UPDATE;
+        TIM2->EGR = TIM_EGR_UG;
+        ADC3->CR2 = ADC_CR2_ADON | ADC_CR2_DMA | ADC_CR2_DDS
+                  | ADC_CR2_EXTSEL_TRGO | ADC_CR2_EXTEN_RISE;
+        TIM2->CR1 = TIM_CR1_CEN;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void adc_dma_stop(void)
+{
+    /* Back to the state after adc_init() */
+    if (RCC->APB1ENR & PERIPH_TIM2_ENABLE) {
+        TIM2->CR1 = 0;
+    }
+    ADC3->CR2 = ADC_CR2_ADON;
+    ADC3->CR1 = 0;
+    ADC3->SR = 0;
+
+    DMA2_S0CR &= ~DMA_CR_EN;
+    while (DMA2_S0CR & DMA_CR_EN) {}
+    NVIC_ICER1 = IRQ_DMA2_STREAM0;
+    DMA2_LIFCR = DMA_S0_ALL_FLAGS;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_dma_statistics(uint32_t *nr_of_samples, uint32_t *busy_cycles)
+{
+    *nr_of_samples = dma_samples;
+    *busy_cycles = dma_busy_cycles;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_start_async(adc_resolution_t resolution, adc_async_t *handle)
+{
+    handle->done = 0;
+    async_handle = handle;
+
+    NVIC_ISER0 = IRQ_ADC;
+    ADC3->CR1 = resolution | ADC_CR1_EOCIE;
+    ADC3->CR2 |= ADC_CR2_SWSTART;
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_wait_async(adc_async_t *handle)
+{
+    while (!handle->done) {}
+
+    return handle->value;
+}
+
+
+/*
+ *  See header file
+ */
+void ADC_IRQHandler(void)
+{
+    adc_async_t *handle = async_handle;
+
+    if (!(ADC3->SR & ADC_SR_EOC)) {
+        return;
+    }
+
+    /* Reading DR clears EOC, EOCIE off until the next start */
+    ADC3->CR1 &= ~ADC_CR1_EOCIE;
+    if (handle == 0) {
+        (void)ADC3->DR;
+        return;
+    }
+    handle->value = (uint16_t)ADC3->DR;
+    handle->done = 1;
+    if (handle->callback != 0) {
+        handle->callback(handle->value);
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void DMA2_Stream0_IRQHandler(void)
+{
+    uint32_t start = CYCLE_COUNTER;
+    uint32_t status = DMA2_LISR;
+
+    DMA2_LIFCR = status & DMA_S0_ALL_FLAGS;
+
+    /* First half is full, DMA continues in the second half */
+    if (status & DMA_S0_HTIF) {
+        dma_samples += ADC_DMA_BLOCK_SIZE;
+        if (block_callback != 0) {
+            block_callback(&dma_buffer[0], ADC_DMA_BLOCK_SIZE);
+        }
+    }
+
+    /* Second half is full, DMA wraps around to the first half */
+    if (status & DMA_S0_TCIF) {
+        dma_samples += ADC_DMA_BLOCK_SIZE;
+        if (block_callback != 0) {
+            block_callback(&dma_buffer[ADC_DMA_BLOCK_SIZE],
+                           ADC_DMA_BLOCK_SIZE);
+        }
+    }
+
+    dma_busy_cycles += CYCLE_COUNTER - start;
+}
@@ -31,6 +31,81 @@ typedef enum {
     ADC_RES_6BIT = (0x3 << 24u),
 } adc_resolution_t;
 
+/* Sampling time in ADC clock cycles (SMPx field of SMPR1/SMPR2) */
+typedef enum {
+    ADC_SMP_3CYC = 0x0,
+    ADC_SMP_15CYC = 0x1,
+    ADC_SMP_28CYC = 0x2,
+    ADC_SMP_56CYC = 0x3,
+    ADC_SMP_84CYC = 0x4,
+    ADC_SMP_112CYC = 0x5,
+    ADC_SMP_144CYC = 0x6,
+    ADC_SMP_480CYC = 0x7,
+} adc_sample_time_t;
+
+/*
+ * State of one moving average filter instance.
+ * The length is a power of two, so the average is a shift of the running
+ * sum. Use ADC_AVG_DEFINE to create an instance together with its buffer.
+ */
+typedef struct {
+    uint16_t *buffer;       // history of the last 2^shift samples
+    uint16_t mask;          // 2^shift - 1
+    uint8_t shift;          // log2 of the length
+    uint16_t index;         // position of the oldest sample
+    uint32_t sum;           // running sum over the buffer
+} adc_avg_t;
+
+/*
+ * Called from the DMA interrupt with a block of 'nr_of_samples' samples.
+ * The block stays valid until the callback returns, the DMA is meanwhile
+ * filling the other half of the buffer.
+ */
+typedef void (*adc_block_callback_t)(const uint16_t *block,
+                                     uint16_t nr_of_samples);
+
+/*
+ * Called from the ADC interrupt with the result of adc_start_async().
+ */
+typedef void (*adc_done_callback_t)(uint16_t value);
+
+/*
+ * Handle of one asynchronous conversion. 'done' is set by the EOC
+ * interrupt after 'value' is written, poll it or use adc_wait_async().
+ */
+typedef struct {
+    adc_done_callback_t callback;   // optional, 0 = poll only
+    volatile uint16_t value;
+    volatile uint8_t done;
+} adc_async_t;
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* Maximal length of a moving average filter: 2^10 = 1024 samples */
+#define ADC_AVG_MAX_LOG2    10u
+
+/* adc_avg_benchmark(): lengths 2^0, 2^4, 2^6, 2^8, 2^10, timed samples */
+#define ADC_AVG_NR_OF_BENCH_LENGTHS 5u
+#define ADC_AVG_BENCH_SAMPLES       256u
+
+/* Number of samples per block in continuous acquisition (half buffer) */
+#define ADC_DMA_BLOCK_SIZE  256u
+
+/* Sample rate for adc_dma_start(): convert back to back, no timer */
+#define ADC_RATE_CONTINUOUS 0u
+
+/*
+ * Defines a moving average filter instance NAME with 2^LOG2 samples.
+ * LOG2 must be a constant between 0 and ADC_AVG_MAX_LOG2.
+ */
+#define ADC_AVG_DEFINE(NAME, LOG2)                                          \
+    typedef char NAME##_length_check[((LOG2) <= ADC_AVG_MAX_LOG2) ? 1 : -1]; \
+    static uint16_t NAME##_buffer[1u << (LOG2)];                             \
+    static adc_avg_t NAME = { NAME##_buffer, (1u << (LOG2)) - 1u, (LOG2),    \
+                              0u, 0u }
+
 
 /* -- Public function declarations
  * ------------------------------------------------------------------------- */
@@ -49,6 +124,12 @@ void adc_init(void);
  */
 uint16_t adc_get_value(adc_resolution_t resolution);
 
+/*
+ * Sets the sampling time of channel 4 (PF.6). Applies to single
+ * conversions and to conversions started later with adc_dma_start().
+ */
+void adc_set_sample_time(adc_sample_time_t sample_time);
+
 /*
  * Moving average filter
  * Contains a FIFO with the history of the last 16 adc_values.
@@ -56,4 +137,75 @@ uint16_t adc_get_value(adc_resolution_t resolution);
  * calculated and returned.
  */
 uint16_t adc_filter_value(uint16_t adc_value);
+
+/*
+ * Clears the history and the running sum of the moving average 'avg'.
+ */
+void adc_avg_reset(adc_avg_t *avg);
+
+/*
+ * Replaces the oldest sample of the moving average 'avg' by adc_value and
+ * returns the average over the whole history.
+ * Constant time for every length: one load, one store, one add/sub and
+ * one shift.
+ */
+uint16_t adc_avg_update(adc_avg_t *avg, uint16_t adc_value);
+
+/*
+ * Times adc_avg_update() with the cycle counter for 1, 16, 64, 256 and
+ * 1024 samples and returns the cycles per sample over
+ * ADC_AVG_BENCH_SAMPLES samples in 'cycles', index 0 = 1 sample.
+ */
+void adc_avg_benchmark(uint32_t cycles[ADC_AVG_NR_OF_BENCH_LENGTHS]);
+
+/*
+ * Starts continuous conversions on PF.6 with the specified resolution.
+ * With sample_rate_hz = ADC_RATE_CONTINUOUS the conversions run back to
+ * back, otherwise each conversion is triggered by the TRGO (update event)
+ * of TIM2 at sample_rate_hz. The rate must be below the maximal rate of
+ * the resolution (about 480 kHz at 12 bit with 28 cycles sampling time).
+ * DMA2 stream 0 writes the samples into a double buffer of two blocks of
+ * ADC_DMA_BLOCK_SIZE samples. Whenever a block is full (half transfer and
+ * transfer complete interrupt) it is handed to 'callback'.
+ * adc_get_value() must not be used until adc_dma_stop() is called.
+ */
+void adc_dma_start(adc_resolution_t resolution, uint32_t sample_rate_hz,
+                   adc_block_callback_t callback);
+
+/*
+ * Stops continuous conversions and the DMA, single conversions with
+ * adc_get_value() are possible again.
+ */
+void adc_dma_stop(void);
+
+/*
+ * Returns the number of samples acquired and the CPU cycles spent in the
+ * DMA interrupt (including the callback) since the first adc_dma_start().
+ * Both counters wrap around, use differences of two calls.
+ */
+void adc_dma_statistics(uint32_t *nr_of_samples, uint32_t *busy_cycles);
+
+/*
+ * Starts a single conversion of PF.6 with the specified resolution and
+ * returns immediately. The EOC interrupt stores the result in 'handle'
+ * and calls handle->callback, so the caller can work on the previous
+ * value while the next conversion runs. One conversion at a time, not
+ * together with adc_get_value() or adc_dma_start().
+ */
+void adc_start_async(adc_resolution_t resolution, adc_async_t *handle);
+
+/*
+ * Waits for the conversion of adc_start_async() and returns its value.
+ */
+uint16_t adc_wait_async(adc_async_t *handle);
+
+/*
+ * Interrupt service routine of DMA2 stream 0
+ */
+void DMA2_Stream0_IRQHandler(void);
+
+/*
+ * Interrupt service routine of ADC1..3 (EOC of adc_start_async())
+ */
+void ADC_IRQHandler(void);
 #endif
@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_auto.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_auto.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define NR_OF_RESOLUTIONS   4u
+#define RES_INDEX_12BIT     (NR_OF_RESOLUTIONS - 1u)
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+/* Coarsest (fastest) first */
+static const adc_resolution_t resolutions[NR_OF_RESOLUTIONS] = {
+    ADC_RES_6BIT, ADC_RES_8BIT, ADC_RES_10BIT, ADC_RES_12BIT
+};
+static const uint8_t bits[NR_OF_RESOLUTIONS] = { 6, 8, 10, 12 };
+
+/* 3.3 V / (2^bits - 1) in uV */
+static const uint32_t lsb_uv[NR_OF_RESOLUTIONS] = { 52381, 12941, 3226, 806 };
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static uint8_t resolution_index(const adc_auto_t *controller);
+static void set_resolution(adc_auto_t *controller, uint8_t index);
+static uint32_t absolute_difference(uint32_t a, uint32_t b);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_auto_init(adc_auto_t *controller, uint32_t target_uv)
+{
+    set_resolution(controller, RES_INDEX_12BIT);
+    controller->sample_time = ADC_SMP_3CYC;
+    controller->target_uv = target_uv;
+    controller->slew_uv = 0;
+    controller->noise_uv = 0;
+    controller->nr_of_previous = 0;
+    controller->dwell = ADC_AUTO_DWELL;
+    controller->nr_of_changes = 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_auto_update(adc_auto_t *controller, uint16_t value)
+{
+    uint8_t index = resolution_index(controller);
+    uint32_t x = value * lsb_uv[index];
+    uint32_t p0 = controller->previous_uv[0];
+    uint32_t p1 = controller->previous_uv[1];
+    uint32_t bound;
+    uint32_t noise_bound;
+    uint8_t changed = 1;
+
+    if (controller->nr_of_previous >= 1) {
+        controller->slew_uv += (absolute_difference(x, p0)
+                                >> ADC_AUTO_EMA_SHIFT)
+                               - (controller->slew_uv >> ADC_AUTO_EMA_SHIFT);
+    }
+    if (controller->nr_of_previous >= 2) {
+        /* second difference: free of a linear slope */
+        controller->noise_uv += (absolute_difference(x + p1, 2u * p0)
+                                 >> (ADC_AUTO_EMA_SHIFT + 1u))
+                                - (controller->noise_uv >> ADC_AUTO_EMA_SHIFT);
+    } else {
+        controller->nr_of_previous++;
+    }
+    controller->previous_uv[1] = p0;
+    controller->previous_uv[0] = x;
+
+    if (controller->dwell > 0) {
+        controller->dwell--;
+        return 0;
+    }
+
+    bound = controller->slew_uv / 2u;
+    if (bound < controller->target_uv) {
+        bound = controller->target_uv;
+    }
+    noise_bound = lsb_uv[index];
+    if (noise_bound < controller->target_uv) {
+        noise_bound = controller->target_uv;
+    }
+
+    if (lsb_uv[index] > bound && index < RES_INDEX_12BIT) {
+        set_resolution(controller, index + 1u);
+    } else if (index > 0 && lsb_uv[index - 1u] <= bound / 2u) {
+        set_resolution(controller, index - 1u);
+    } else if (controller->noise_uv > noise_bound
+               && controller->sample_time < ADC_SMP_480CYC) {
+        controller->sample_time =
+            (adc_sample_time_t)(controller->sample_time + 1);
+    } else if (controller->noise_uv < noise_bound / 2u
+               && controller->sample_time > ADC_SMP_3CYC) {
+        controller->sample_time =
+            (adc_sample_time_t)(controller->sample_time - 1);
+    } else {
+        changed = 0;
+    }
+
+    if (changed) {
+        /* the estimates are in uV and stay valid, the history does not */
+        controller->nr_of_previous = 0;
+        controller->dwell = ADC_AUTO_DWELL;
+        controller->nr_of_changes++;
+    }
+    return changed;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static uint8_t resolution_index(const adc_auto_t *controller)
+{
+    return (uint8_t)((controller->bits - bits[0]) / 2u);
+}
+
+static void set_resolution(adc_auto_t *controller, uint8_t index)
+{
+    controller->resolution = resolutions[index];
+    controller->bits = bits[index];
+}
+
+static uint32_t absolute_difference(uint32_t a, uint32_t b)
+{
+    return (a > b) ? a - b : b - a;
+}
@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_auto.
+ * --
+ * -- Chooses resolution and sampling time on the fly from the measured slew
+ * -- and noise of the signal.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_AUTO_H
+#define _ADC_AUTO_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* Samples without a decision after each change */
+#define ADC_AUTO_DWELL          64u
+
+/* Estimates are exponential moving averages with alpha = 1/16 */
+#define ADC_AUTO_EMA_SHIFT      4u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    adc_resolution_t resolution;    // current decision
+    adc_sample_time_t sample_time;  // current decision
+    uint8_t bits;                   // bits of 'resolution'
+    uint32_t target_uv;             // precision to hold
+    uint32_t slew_uv;               // mean |x[n] - x[n-1]|
+    uint32_t noise_uv;              // mean |x[n] - 2 x[n-1] + x[n-2]| / 2
+    uint32_t previous_uv[2];        // x[n-1], x[n-2]
+    uint8_t nr_of_previous;         // valid entries in previous_uv
+    uint16_t dwell;                 // samples until the next decision
+    uint32_t nr_of_changes;         // decisions taken since init
+} adc_auto_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Starts at 12 bit and 3 cycles sampling time. 'target_uv' is the
+ * precision that must be held while the signal is steady.
+ */
+void adc_auto_init(adc_auto_t *controller, uint32_t target_uv);
+
+/*
+ * Feeds one conversion result taken with controller->resolution and
+ * controller->sample_time. Returns 1 if the controller decided on a new
+ * setting, the caller applies it before the next conversion.
+ *
+ * While the signal moves by more than twice the target per sample, finer
+ * steps than half the slew carry no information: the controller drops to
+ * the coarsest resolution whose LSB is within max(target, slew / 2). It
+ * goes back to a finer resolution as soon as the LSB exceeds that bound,
+ * but to a coarser one only if its LSB is within half of it.
+ * Noise that the resolution can resolve and that exceeds the target
+ * lengthens the sampling time, noise below half of it shortens it again.
+ */
+uint8_t adc_auto_update(adc_auto_t *controller, uint16_t value);
+
+#endif
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_bench.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <reg_stm32f4xx.h>
+
+/* user includes */
+#include "adc_bench.h"
+#include "adc_stats.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_CR2_ADON        (0x1 << 0)
+#define ADC_CR2_CONT        (0x1 << 1)
+#define ADC_CR2_EOCS        (0x1 << 10)
+#define ADC_CR2_SWSTART     (0x1 << 30)
+#define ADC_SR_EOC          (0x1 << 1)
+#define ADC_SR_OVR          (0x1 << 5)
+
+#define FULL_SCALE_MV       3300u
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const adc_resolution_t resolutions[ADC_BENCH_NR_OF_RESOLUTIONS] = {
+    ADC_RES_12BIT, ADC_RES_10BIT, ADC_RES_8BIT, ADC_RES_6BIT
+};
+static const uint8_t bits[ADC_BENCH_NR_OF_RESOLUTIONS] = { 12, 10, 8, 6 };
+static const uint16_t sample_cycles[ADC_BENCH_NR_OF_SAMPLE_TIMES] = {
+    3, 15, 28, 56, 84, 112, 144, 480
+};
+
+static uint16_t samples[ADC_BENCH_NR_OF_SAMPLES];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void measure(adc_bench_entry_t *entry);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_bench_run(adc_bench_table_t *table)
+{
+    uint32_t smpr2 = ADC3->SMPR2;
+    uint8_t r;
+    uint8_t t;
+
+    for (r = 0; r < ADC_BENCH_NR_OF_RESOLUTIONS; r++) {
+        for (t = 0; t < ADC_BENCH_NR_OF_SAMPLE_TIMES; t++) {
+            adc_bench_entry_t *entry = &table->entry[r][t];
+
+            entry->resolution = resolutions[r];
+            entry->sample_time = (adc_sample_time_t)t;
+            entry->bits = bits[r];
+            entry->sample_cycles = sample_cycles[t];
+            measure(entry);
+        }
+    }
+
+    /* Back to the state after adc_init() */
+    ADC3->CR2 = ADC_CR2_ADON;
+    ADC3->CR1 = 0;
+    ADC3->SR = 0;
+    ADC3->SMPR2 = smpr2;
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_bench_fastest(const adc_bench_table_t *table,
+                          uint32_t max_noise_uv)
+{
+    uint8_t best = ADC_BENCH_NONE;
+    uint32_t best_rate = 0;
+    uint8_t r;
+    uint8_t t;
+
+    for (r = 0; r < ADC_BENCH_NR_OF_RESOLUTIONS; r++) {
+        for (t = 0; t < ADC_BENCH_NR_OF_SAMPLE_TIMES; t++) {
+            const adc_bench_entry_t *entry = &table->entry[r][t];
+
+            if (!entry->overrun && entry->noise_uv <= max_noise_uv
+                    && entry->samples_per_s > best_rate) {
+                best_rate = entry->samples_per_s;
+                best = (uint8_t)(r * ADC_BENCH_NR_OF_SAMPLE_TIMES + t);
+            }
+        }
+    }
+    return best;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Converts back to back and only stores the results, so that the loop is
+ * shorter than the fastest conversion (6 bit, 3 cycles -> 9 ADC clock
+ * cycles = 36 CPU cycles). Rate and noise are evaluated afterwards.
+ * EOCS enables the overrun detection without DMA: if the loop misses a
+ * conversion, OVR is set and the measurement ends, the rate would be
+ * that of the loop and not that of the ADC.
+ */
+static void measure(adc_bench_entry_t *entry)
+{
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t sum = 0;
+    uint64_t sum_of_squares = 0;
+    uint64_t variance;
+    uint32_t status;
+    uint32_t nr_of_samples;
+    uint32_t i;
+
+    ADC3->CR2 = ADC_CR2_ADON;
+    ADC3->CR1 = entry->resolution;
+    adc_set_sample_time(entry->sample_time);
+    ADC3->SR = 0;
+    ADC3->CR2 = ADC_CR2_ADON | ADC_CR2_CONT | ADC_CR2_EOCS;
+    ADC3->CR2 |= ADC_CR2_SWSTART;
+
+    for (i = 0; i < ADC_BENCH_NR_OF_SAMPLES; i++) {
+        do {
+            status = ADC3->SR;
+        } while (!(status & (ADC_SR_EOC | ADC_SR_OVR)));
+        if (status & ADC_SR_OVR) {
+            break;
+        }
+        last = CYCLE_COUNTER;
+        samples[i] = (uint16_t)ADC3->DR;        // clears EOC
+        if (i == 0) {
+            first = last;
+        }
+    }
+    nr_of_samples = i;
+    entry->overrun = (ADC3->SR & ADC_SR_OVR) ? 1 : 0;
+    ADC3->CR2 = ADC_CR2_ADON;
+    ADC3->SR = 0;
+
+    /* First to last end of conversion: N - 1 conversion periods */
+    entry->samples_per_s = (last == first) ? 0 :
+        (uint32_t)((uint64_t)(nr_of_samples - 1u) * CPU_CLOCK_HZ
+                   / (last - first));
+    if (nr_of_samples == 0) {
+        entry->mean = 0;
+        entry->noise_milli_lsb = 0;
+        entry->noise_uv = 0;
+        return;
+    }
+
+    for (i = 0; i < nr_of_samples; i++) {
+        sum += samples[i];
+        sum_of_squares += (uint32_t)samples[i] * samples[i];
+    }
+
+    /* N^2 * variance = N * sum(x^2) - sum(x)^2, so sqrt() / N = std dev */
+    variance = nr_of_samples * sum_of_squares - (uint64_t)sum * sum;
+    entry->mean = (uint16_t)(sum / nr_of_samples);
+    entry->noise_milli_lsb = (uint32_t)((uint64_t)adc_stats_isqrt(variance)
+                                        * 1000u / nr_of_samples);
+    entry->noise_uv = (uint32_t)((uint64_t)entry->noise_milli_lsb
+                                 * FULL_SCALE_MV
+                                 / ((1u << entry->bits) - 1u));
+}
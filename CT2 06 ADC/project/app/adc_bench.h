@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_bench.
+ * --
+ * -- Characterizes ADC3 on PF.6 (POT1) for every combination of resolution
+ * -- and sampling time: conversion rate and noise.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_BENCH_H
+#define _ADC_BENCH_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_BENCH_NR_OF_RESOLUTIONS     4u
+#define ADC_BENCH_NR_OF_SAMPLE_TIMES    8u
+
+/* Conversions per measurement */
+#define ADC_BENCH_NR_OF_SAMPLES         1024u
+
+/* Returned by adc_bench_fastest() if no entry meets the noise budget */
+#define ADC_BENCH_NONE                  0xFF
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    adc_resolution_t resolution;
+    adc_sample_time_t sample_time;
+    uint8_t bits;                   // 12, 10, 8 or 6
+    uint16_t sample_cycles;         // sampling time in ADC clock cycles
+    uint32_t samples_per_s;         // measured back to back rate
+    uint16_t mean;                  // mean value in LSB
+    uint32_t noise_milli_lsb;       // standard deviation in 1/1000 LSB
+    uint32_t noise_uv;              // standard deviation in uV
+    uint8_t overrun;                // 1 if the CPU lost conversions
+} adc_bench_entry_t;
+
+/*
+ * Results of one sweep, index [resolution][sample time], resolution
+ * index 0 = 12 bit ... 3 = 6 bit, sample time index = adc_sample_time_t.
+ */
+typedef struct {
+    adc_bench_entry_t entry[ADC_BENCH_NR_OF_RESOLUTIONS]
+                           [ADC_BENCH_NR_OF_SAMPLE_TIMES];
+} adc_bench_table_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Runs all 32 combinations of resolution and sampling time with
+ * ADC_BENCH_NR_OF_SAMPLES continuous conversions each and fills 'table'.
+ * Continuous acquisition with adc_dma_start() must be stopped before.
+ * Leaves ADC3 in the state after adc_init() with the sampling time that
+ * was set before the sweep.
+ */
+void adc_bench_run(adc_bench_table_t *table);
+
+/*
+ * Returns the flat index (resolution * ADC_BENCH_NR_OF_SAMPLE_TIMES +
+ * sample time) of the entry with the highest rate whose noise is at most
+ * 'max_noise_uv' and which had no overrun, or ADC_BENCH_NONE.
+ */
+uint8_t adc_bench_fastest(const adc_bench_table_t *table,
+                          uint32_t max_noise_uv);
+
+#endif
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_calib.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_calib.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ROUNDING            (0x1u << (ADC_CALIB_SHIFT - 1u))
+#define TS_SHIFT            16u
+#define TS_CAL1_DECI_C      300
+#define TS_CAL_SPAN_DECI_C  800     // 110 - 30 deg C
+
+/* Typical values (datasheet) if the calibration words are not plausible */
+#define TS_TYP_CAL1         943u    // 0.76 V at 30 deg C
+#define TS_TYP_CAL2         1191u   // + 80 * 2.5 mV
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+/* Keeps the compiler from removing the measured loops */
+static volatile uint32_t sink;
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_calib_update(adc_calib_t *calib, uint16_t vrefint)
+{
+    uint32_t vdda = ADC_CALIB_CAL_MV;
+    uint32_t cal1 = ADC_CALIB_TS_CAL1;
+    uint32_t cal2 = ADC_CALIB_TS_CAL2;
+    uint8_t bits;
+
+    if (vrefint != 0) {
+        vdda = (ADC_CALIB_CAL_MV * ADC_CALIB_VREFINT_CAL + vrefint / 2u)
+               / vrefint;
+    }
+    if (vdda > ADC_CALIB_MAX_MV) {
+        vdda = ADC_CALIB_MAX_MV;
+    }
+    calib->vdda_mv = vdda;
+
+    for (bits = 0; bits <= ADC_CALIB_MAX_BITS; bits++) {
+        calib->reciprocal[bits] = (bits == 0) ? 0 :
+            (uint32_t)((((uint64_t)vdda << ADC_CALIB_SHIFT)
+                        + ((1u << bits) - 1u) / 2u) / ((1u << bits) - 1u));
+    }
+
+    if (cal2 <= cal1 || cal2 > 0xFFF) {
+        cal1 = TS_TYP_CAL1;
+        cal2 = TS_TYP_CAL2;
+    }
+
+    /*
+     * T = 30 + 80 * (value * VDDA / 3.3 V - cal1) / (cal2 - cal1)
+     *   = ts_offset + value * ts_gain
+     */
+    calib->ts_gain = (uint32_t)(((uint64_t)vdda * TS_CAL_SPAN_DECI_C
+                                 << TS_SHIFT)
+                                / (ADC_CALIB_CAL_MV * (cal2 - cal1)));
+    calib->ts_offset = TS_CAL1_DECI_C
+                       - (int32_t)(cal1 * TS_CAL_SPAN_DECI_C / (cal2 - cal1));
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_calib_to_mv(const adc_calib_t *calib, uint16_t value,
+                         uint8_t bits)
+{
+    return (uint16_t)((value * calib->reciprocal[bits] + ROUNDING)
+                      >> ADC_CALIB_SHIFT);
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_calib_bits(adc_resolution_t resolution)
+{
+    /* RES field: 0 = 12 bit ... 3 = 6 bit */
+    return (uint8_t)(12u - 2u * (((uint32_t)resolution >> 24) & 0x3u));
+}
+
+
+/*
+ *  See header file
+ */
+int16_t adc_calib_temperature(const adc_calib_t *calib, uint16_t value)
+{
+    return (int16_t)(calib->ts_offset
+                     + (int32_t)((value * calib->ts_gain) >> TS_SHIFT));
+}
+
+
+/*
+ *  See header file
+ */
+void adc_calib_check(const adc_calib_t *calib, uint8_t bits,
+                     adc_calib_report_t *report)
+{
+    uint32_t full_scale = (1u << bits) - 1u;
+    uint32_t vdda = calib->vdda_mv;
+    uint32_t max_error = 0;
+    uint32_t start;
+    uint32_t value;
+    uint32_t exact;
+    uint32_t fast;
+    uint32_t sum;
+
+    for (value = 0; value <= full_scale; value++) {
+        exact = (value * vdda + full_scale / 2u) / full_scale;
+        fast = adc_calib_to_mv(calib, (uint16_t)value, bits);
+        if (exact > fast && exact - fast > max_error) {
+            max_error = exact - fast;
+        } else if (fast > exact && fast - exact > max_error) {
+            max_error = fast - exact;
+        }
+    }
+    report->max_error_mv = max_error;
+
+    sum = 0;
+    start = CYCLE_COUNTER;
+    for (value = 0; value <= full_scale; value++) {
+        sum += (value * vdda + full_scale / 2u) / full_scale;
+    }
+    report->cycles_division = (CYCLE_COUNTER - start) / (full_scale + 1u);
+    sink = sum;
+
+    sum = 0;
+    start = CYCLE_COUNTER;
+    for (value = 0; value <= full_scale; value++) {
+        sum += adc_calib_to_mv(calib, (uint16_t)value, bits);
+    }
+    report->cycles_reciprocal = (CYCLE_COUNTER - start) / (full_scale + 1u);
+    sink = sum;
+}
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_calib.
+ * --
+ * -- Converts samples to millivolt and degree celsius with the supply
+ * -- voltage measured on VREFINT and the factory calibration words.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_CALIB_H
+#define _ADC_CALIB_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* Factory calibration words, 12 bit raw values taken at VDDA = 3.3 V */
+#define ADC_CALIB_VREFINT_CAL   (*(const uint16_t *)0x1FFF7A2A)  // 30 deg C
+#define ADC_CALIB_TS_CAL1       (*(const uint16_t *)0x1FFF7A2C)  // 30 deg C
+#define ADC_CALIB_TS_CAL2       (*(const uint16_t *)0x1FFF7A2E)  // 110 deg C
+#define ADC_CALIB_CAL_MV        3300u
+
+/* Up to 16 bit for oversampled values */
+#define ADC_CALIB_MAX_BITS      16u
+
+/*
+ * Fraction bits of the reciprocals. value * reciprocal is at most
+ * VDDA * 2^20, which fits into 32 bit up to VDDA = 4095 mV.
+ */
+#define ADC_CALIB_SHIFT         20u
+#define ADC_CALIB_MAX_MV        3600u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t vdda_mv;                               // measured supply
+    uint32_t reciprocal[ADC_CALIB_MAX_BITS + 1u];   // VDDA/(2^n-1), Q20
+    uint32_t ts_gain;                               // 0.1 deg C per LSB, Q16
+    int32_t ts_offset;                              // 0.1 deg C
+} adc_calib_t;
+
+/* Division path against reciprocal path over all values of one resolution */
+typedef struct {
+    uint32_t max_error_mv;
+    uint32_t cycles_division;       // per sample
+    uint32_t cycles_reciprocal;     // per sample
+} adc_calib_report_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Computes the supply voltage from a 12 bit VREFINT conversion and the
+ * reciprocals for every resolution. This is the only place that divides.
+ * 'vrefint' = 0 assumes 3.3 V.
+ */
+void adc_calib_update(adc_calib_t *calib, uint16_t vrefint);
+
+/*
+ * Converts 'value' with 'bits' valid bits to millivolt:
+ * one multiply, one add for rounding and one shift.
+ */
+uint16_t adc_calib_to_mv(const adc_calib_t *calib, uint16_t value,
+                         uint8_t bits);
+
+/*
+ * Returns the number of bits of 'resolution'.
+ */
+uint8_t adc_calib_bits(adc_resolution_t resolution);
+
+/*
+ * Converts a 12 bit temperature sensor conversion to 0.1 deg C with the
+ * two point factory calibration (30 and 110 deg C).
+ */
+int16_t adc_calib_temperature(const adc_calib_t *calib, uint16_t value);
+
+/*
+ * Converts every value of 'bits' with the rounded division
+ * value * VDDA / (2^n - 1) and with adc_calib_to_mv() and reports the
+ * largest difference and the cycles per conversion of both paths.
+ */
+void adc_calib_check(const adc_calib_t *calib, uint8_t bits,
+                     adc_calib_report_t *report);
+
+#endif
@@ -0,0 +1,257 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_capture.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <reg_stm32f4xx.h>
+
+/* user includes */
+#include "adc_capture.h"
+#include "cycle_counter.h"
+#include "hal_fmc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PERIPH_GPIOC_ENABLE (0x00000004)
+#define PERIPH_DMA2_ENABLE  (0x00400000)
+#define PERIPH_ADC1_ENABLE  (0x00000100)
+#define PERIPH_ADC2_ENABLE  (0x00000200)
+#define PERIPH_ADC3_ENABLE  (0x00000400)
+
+/* Configuring pin for ADC: PC.0 */
+#define GPIOC_MODER_ANALOG  (0x3 << 0)
+
+/* ADC common control: triple interleaved, DMA mode 2, 5 cycles delay */
+#define CCR_MULTI_TRIPLE    (0x17 << 0)
+#define CCR_DELAY_5         (0x0 << 8)
+#define CCR_DMA_MODE_2      (0x2 << 14)
+
+#define ADC_CR2_ADON        (0x1 << 0)
+#define ADC_CR2_CONT        (0x1 << 1)
+#define ADC_CR2_SWSTART     (0x1 << 30)
+#define ADC_SR_OVR          (0x1 << 5)
+
+/* DMA2 stream 4 channel 0 is connected to ADC1 (master) */
+#define DMA2_BASE           (0x40026400)
+#define DMA2_HISR           (*((volatile uint32_t *)(DMA2_BASE + 0x04)))
+#define DMA2_HIFCR          (*((volatile uint32_t *)(DMA2_BASE + 0x0C)))
+#define DMA2_S4CR           (*((volatile uint32_t *)(DMA2_BASE + 0x70)))
+#define DMA2_S4NDTR         (*((volatile uint32_t *)(DMA2_BASE + 0x74)))
+#define DMA2_S4PAR          (*((volatile uint32_t *)(DMA2_BASE + 0x78)))
+#define DMA2_S4M0AR         (*((volatile uint32_t *)(DMA2_BASE + 0x7C)))
+#define DMA2_S4FCR          (*((volatile uint32_t *)(DMA2_BASE + 0x84)))
+
+#define DMA_S4_TEIF         (0x1 << 3)
+#define DMA_S4_TCIF         (0x1 << 5)
+#define DMA_S4_ALL_FLAGS    (0x3D)
+
+#define DMA_CR_EN           (0x1 << 0)
+#define DMA_CR_ADC1         ((0x0 << 25)    /* CHSEL = 0 -> ADC1        */ \
+                           | (0x2 << 13)    /* MSIZE = 32 bit           */ \
+                           | (0x2 << 11)    /* PSIZE = 32 bit           */ \
+                           | (0x1 << 10)    /* MINC                     */ \
+                           | (0x1 << 16))   /* PL = medium, per -> mem  */
+
+/* FMC timing in HCLK cycles (84 MHz) for a 70 ns SRAM */
+#define FMC_ADDRESS_SETUP   1
+#define FMC_ADDRESS_HOLD    1
+#define FMC_DATA_SETUP      6
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+/* Registers of an ADC that configure_adc() overwrites */
+typedef struct {
+    uint32_t cr1;
+    uint32_t cr2;
+    uint32_t smpr1;
+    uint32_t smpr2;
+    uint32_t sqr1;
+    uint32_t sqr2;
+    uint32_t sqr3;
+} adc_setting_t;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void configure_adc(reg_adc_t *adc);
+static void save_adc(const reg_adc_t *adc, adc_setting_t *setting);
+static void restore_adc(reg_adc_t *adc, const adc_setting_t *setting);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_capture_init(void)
+{
+    hal_fmc_sram_init_t init;
+    hal_fmc_sram_timing_t timing;
+
+    init.address_mux = DISABLE;
+    init.type = HAL_FMC_TYPE_SRAM;
+    init.width = HAL_FMC_WIDTH_8B;
+    init.write_enable = ENABLE;
+
+    timing.address_setup = FMC_ADDRESS_SETUP;
+    timing.address_hold = FMC_ADDRESS_HOLD;
+    timing.data_setup = FMC_DATA_SETUP;
+
+    hal_fmc_init_sram(HAL_FMC_SRAM_BANK2, init, timing);
+
+    RCC->AHB1ENR |= PERIPH_GPIOC_ENABLE | PERIPH_DMA2_ENABLE;
+    RCC->APB2ENR |= PERIPH_ADC1_ENABLE | PERIPH_ADC2_ENABLE
+                  | PERIPH_ADC3_ENABLE;
+    GPIOC->MODER |= GPIOC_MODER_ANALOG;
+}
+
+
+/*
+ *  See header file
+ */
+adc_capture_result_t adc_capture_burst(uint32_t nr_of_samples)
+{
+    adc_capture_result_t result;
+    adc_setting_t setting[3];
+    uint32_t ccr = ADCCOM->CCR;
+    uint32_t start;
+    uint32_t status;
+
+    if (nr_of_samples > ADC_CAPTURE_MAX_SAMPLES) {
+        nr_of_samples = ADC_CAPTURE_MAX_SAMPLES;
+    }
+    nr_of_samples &= ~0x1u;
+
+    /* One word = two samples per DMA request, no FIFO */
+    DMA2_S4CR = 0;
+    while (DMA2_S4CR & DMA_CR_EN) {}
+    DMA2_HIFCR = DMA_S4_ALL_FLAGS;
+    DMA2_S4PAR = (uint32_t)&ADCCOM->CDR;
+    DMA2_S4M0AR = ADC_CAPTURE_BASE;
+    DMA2_S4NDTR = nr_of_samples / 2u;
+    DMA2_S4FCR = 0;
+    DMA2_S4CR = DMA_CR_ADC1;
+    DMA2_S4CR |= DMA_CR_EN;
+
+    /* adc.c and adc_scan.c keep their channels and sampling times */
+    save_adc(ADC1, &setting[0]);
+    save_adc(ADC2, &setting[1]);
+    save_adc(ADC3, &setting[2]);
+    configure_adc(ADC1);
+    configure_adc(ADC2);
+    configure_adc(ADC3);
+    ADCCOM->CCR = CCR_MULTI_TRIPLE | CCR_DELAY_5 | CCR_DMA_MODE_2;
+
+    /* The master starts all three ADCs */
+    start = CYCLE_COUNTER;
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+
+    do {
+        status = DMA2_HISR;
+    } while (!(status & (DMA_S4_TCIF | DMA_S4_TEIF))
+             && !(ADC1->SR & ADC_SR_OVR));
+    result.cycles = CYCLE_COUNTER - start;
+
+    /* Stop conversions and return to independent mode */
+    ADC1->CR2 = 0;
+    ADC2->CR2 = 0;
+    ADC3->CR2 = 0;
+    ADCCOM->CCR = ccr;
+    DMA2_S4CR &= ~DMA_CR_EN;
+    result.overrun = (ADC1->SR & ADC_SR_OVR) ? 1 : 0;
+    restore_adc(ADC1, &setting[0]);
+    restore_adc(ADC2, &setting[1]);
+    restore_adc(ADC3, &setting[2]);
+
+    result.nr_of_samples = nr_of_samples - 2u * DMA2_S4NDTR;
+    result.samples_per_s = (result.cycles == 0) ? 0 :
+        (uint32_t)((uint64_t)result.nr_of_samples * CPU_CLOCK_HZ
+                   / result.cycles);
+
+    ADC1->SR = 0;
+    ADC2->SR = 0;
+    ADC3->SR = 0;
+    DMA2_HIFCR = DMA_S4_ALL_FLAGS;
+
+    return result;
+}
+
+
+/*
+ *  See header file
+ */
+const volatile uint16_t *adc_capture_samples(void)
+{
+    return (const volatile uint16_t *)ADC_CAPTURE_BASE;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * 12 bit, continuous, single conversion of ADC_CAPTURE_CHANNEL with
+ * 3 cycles sampling time (SMPR1 holds channels 10 to 18).
+ */
+static void configure_adc(reg_adc_t *adc)
+{
+    adc->CR2 = 0;
+    adc->SR = 0;
+    adc->CR1 = 0;
+    adc->SMPR1 = 0;
+    adc->SMPR2 = 0;
+    adc->SQR1 = 0;
+    adc->SQR2 = 0;
+    adc->SQR3 = ADC_CAPTURE_CHANNEL;
+    adc->CR2 = ADC_CR2_ADON | ADC_CR2_CONT;
+}
+
+
+/*
+ * Copies the registers of 'adc' that configure_adc() overwrites
+ */
+static void save_adc(const reg_adc_t *adc, adc_setting_t *setting)
+{
+    setting->cr1 = adc->CR1;
+    setting->cr2 = adc->CR2 & ~ADC_CR2_SWSTART;
+    setting->smpr1 = adc->SMPR1;
+    setting->smpr2 = adc->SMPR2;
+    setting->sqr1 = adc->SQR1;
+    setting->sqr2 = adc->SQR2;
+    setting->sqr3 = adc->SQR3;
+}
+
+
+/*
+ * Writes 'setting' back to the stopped 'adc', CR2 last. ADON alone does
+ * not start a conversion, so a restored CONT or DMA bit waits for the
+ * next start of adc.c.
+ */
+static void restore_adc(reg_adc_t *adc, const adc_setting_t *setting)
+{
+    adc->CR1 = setting->cr1;
+    adc->SMPR1 = setting->smpr1;
+    adc->SMPR2 = setting->smpr2;
+    adc->SQR1 = setting->sqr1;
+    adc->SQR2 = setting->sqr2;
+    adc->SQR3 = setting->sqr3;
+    adc->CR2 = setting->cr2;
+}
@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_capture.
+ * --
+ * -- Burst capture with ADC1, ADC2 and ADC3 in triple interleaved mode into
+ * -- the external SRAM on bank 2 of the FMC.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_CAPTURE_H
+#define _ADC_CAPTURE_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/*
+ * External SRAM on NE2. The device of the SRAM lab has 11 address lines,
+ * i.e. 2 KByte. Adapt the size for a larger device.
+ */
+#define ADC_CAPTURE_BASE        0x64000000
+#define ADC_CAPTURE_SIZE        0x800
+
+/* Samples of 16 bit that fit into the external SRAM */
+#define ADC_CAPTURE_MAX_SAMPLES (ADC_CAPTURE_SIZE / 2u)
+
+/*
+ * Channel 10 (PC.0) is connected to all three ADCs. PF.6 (POT1) is only
+ * connected to ADC3 and cannot be used in interleaved mode.
+ */
+#define ADC_CAPTURE_CHANNEL     10u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t nr_of_samples;     // samples written to the external SRAM
+    uint32_t cycles;            // CPU cycles from start to end of transfer
+    uint32_t samples_per_s;     // sustained rate
+    uint8_t overrun;            // 1 if the DMA did not keep up
+} adc_capture_result_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Initializes the FMC for the external SRAM and PC.0 as analog input.
+ */
+void adc_capture_init(void);
+
+/*
+ * Captures 'nr_of_samples' 12 bit samples (limited to
+ * ADC_CAPTURE_MAX_SAMPLES, rounded down to an even number) with the three
+ * ADCs interleaved by 5 ADC clock cycles and 3 cycles sampling time,
+ * i.e. 21 MHz / 5 = 4.2 MSPS.
+ * Two samples are packed into one word (DMA mode 2) and transferred by
+ * DMA2 stream 4 into the external SRAM. The function waits for the end of
+ * the transfer and leaves all ADCs in independent mode with the channels,
+ * sampling times and resolution they had before.
+ * Continuous acquisition with adc_dma_start() must be stopped before.
+ */
+adc_capture_result_t adc_capture_burst(uint32_t nr_of_samples);
+
+/*
+ * Returns a pointer to the samples in the external SRAM
+ */
+const volatile uint16_t *adc_capture_samples(void);
+
+#endif
@@ -0,0 +1,274 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_fft.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <math.h>
+
+/* user includes */
+#include "adc_fft.h"
+#include "adc_stats.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Butterfly primitives on packed complex values (SIMD only with the
+ * target set to Cortex-M4, see adc_fft.h):
+ *   HADD(a, b)  (a + b) / 2
+ *   HSUB(a, b)  (a - b) / 2
+ *   HSAX(a, b)  (a - j b) / 2
+ *   HASX(a, b)  (a + j b) / 2
+ *   CMUL(a, w)  a * w in Q15
+ */
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+
+#include <arm_acle.h>
+
+#define HADD(a, b)  ((int32_t)__shadd16((a), (b)))
+#define HSUB(a, b)  ((int32_t)__shsub16((a), (b)))
+#define HSAX(a, b)  ((int32_t)__shsax((a), (b)))
+#define HASX(a, b)  ((int32_t)__shasx((a), (b)))
+#define CMUL(a, w)  ADC_FFT_PACK(__smusd((a), (w)) >> 15, \
+                                 __smuadx((a), (w)) >> 15)
+
+#else
+
+#define HADD(a, b)  ADC_FFT_PACK((ADC_FFT_RE(a) + ADC_FFT_RE(b)) >> 1, \
+                                 (ADC_FFT_IM(a) + ADC_FFT_IM(b)) >> 1)
+#define HSUB(a, b)  ADC_FFT_PACK((ADC_FFT_RE(a) - ADC_FFT_RE(b)) >> 1, \
+                                 (ADC_FFT_IM(a) - ADC_FFT_IM(b)) >> 1)
+#define HSAX(a, b)  ADC_FFT_PACK((ADC_FFT_RE(a) + ADC_FFT_IM(b)) >> 1, \
+                                 (ADC_FFT_IM(a) - ADC_FFT_RE(b)) >> 1)
+#define HASX(a, b)  ADC_FFT_PACK((ADC_FFT_RE(a) - ADC_FFT_IM(b)) >> 1, \
+                                 (ADC_FFT_IM(a) + ADC_FFT_RE(b)) >> 1)
+#define CMUL(a, w)  ADC_FFT_PACK(                                           \
+    ((int32_t)ADC_FFT_RE(a) * ADC_FFT_RE(w)                                 \
+     - (int32_t)ADC_FFT_IM(a) * ADC_FFT_IM(w)) >> 15,                       \
+    ((int32_t)ADC_FFT_RE(a) * ADC_FFT_IM(w)                                 \
+     + (int32_t)ADC_FFT_IM(a) * ADC_FFT_RE(w)) >> 15)
+
+#endif
+
+/* W^k for k < 3/4 N_max, the largest index of a radix-4 stage */
+#define NR_OF_TWIDDLES      (3u * ADC_FFT_MAX_SIZE / 4u)
+#define Q15_ONE             32767.0
+#define PI                  3.14159265358979323846
+
+/* Pseudo random samples of adc_fft_benchmark(), as in adc_median.c */
+#define LCG_NEXT(x)         ((x) * 1664525u + 1013904223u)
+#define LCG_SEED            12345u
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+/* exp(-j 2 pi k / N_max) */
+static int32_t twiddle[NR_OF_TWIDDLES];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void bit_reverse(int32_t *buffer, uint8_t log2);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_fft_init(void)
+{
+    uint32_t k;
+    double angle;
+
+    for (k = 0; k < NR_OF_TWIDDLES; k++) {
+        angle = 2.0 * PI * k / ADC_FFT_MAX_SIZE;
+        twiddle[k] = ADC_FFT_PACK((int16_t)floor(Q15_ONE * cos(angle) + 0.5),
+                                  (int16_t)floor(-Q15_ONE * sin(angle) + 0.5));
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void adc_fft_load(int32_t *buffer, const uint16_t *samples,
+                  uint16_t nr_of_points, uint8_t bits)
+{
+    uint32_t sum = 0;
+    int32_t mean;
+    int32_t x;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_points; i++) {
+        sum += samples[i];
+    }
+    mean = (int32_t)(sum / nr_of_points);
+
+    for (i = 0; i < nr_of_points; i++) {
+        x = ((int32_t)samples[i] - mean) * (1 << (15 - bits));
+        if (x > INT16_MAX) {
+            x = INT16_MAX;
+        } else if (x < INT16_MIN) {
+            x = INT16_MIN;
+        }
+        buffer[i] = ADC_FFT_PACK(x, 0);
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void adc_fft_forward(int32_t *buffer, uint8_t log2)
+{
+    uint32_t n = 1u << log2;
+    uint32_t length = n;
+    uint32_t stride = ADC_FFT_MAX_SIZE >> log2;     // twiddle step of W_n
+    uint32_t quarter;
+    uint32_t block;
+    uint32_t i;
+
+    /* Odd log2: one radix-2 decimation in frequency first */
+    if (log2 & 0x1u) {
+        uint32_t half = n / 2u;
+
+        for (i = 0; i < half; i++) {
+            int32_t a = buffer[i];
+            int32_t b = buffer[i + half];
+
+            buffer[i] = HADD(a, b);
+            buffer[i + half] = CMUL(HSUB(a, b), twiddle[i * stride]);
+        }
+        length = half;
+        stride *= 2u;
+    }
+
+    /*
+     * Radix-4 decimation in frequency. The two middle outputs are stored
+     * swapped, so that the result is in bit reversed (not base 4 digit
+     * reversed) order, which also fits the leading radix-2 stage.
+     */
+    for (; length >= 4u; length /= 4u, stride *= 4u) {
+        quarter = length / 4u;
+        for (block = 0; block < n; block += length) {
+            int32_t *x = &buffer[block];
+
+            for (i = 0; i < quarter; i++) {
+                int32_t a = HADD(x[i], x[i + 2u * quarter]);
+                int32_t b = HSUB(x[i], x[i + 2u * quarter]);
+                int32_t c = HADD(x[i + quarter], x[i + 3u * quarter]);
+                int32_t d = HSUB(x[i + quarter], x[i + 3u * quarter]);
+
+                x[i] = HADD(a, c);
+                if (i == 0) {
+                    x[quarter] = HSUB(a, c);
+                    x[2u * quarter] = HSAX(b, d);
+                    x[3u * quarter] = HASX(b, d);
+                } else {
+                    x[i + quarter] = CMUL(HSUB(a, c),
+                                          twiddle[2u * i * stride]);
+                    x[i + 2u * quarter] = CMUL(HSAX(b, d),
+                                               twiddle[i * stride]);
+                    x[i + 3u * quarter] = CMUL(HASX(b, d),
+                                               twiddle[3u * i * stride]);
+                }
+            }
+        }
+    }
+
+    bit_reverse(buffer, log2);
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_fft_peak(const int32_t *buffer, uint8_t log2,
+                      uint16_t *amplitude)
+{
+    uint16_t half = (uint16_t)(1u << (log2 - 1u));
+    uint32_t best_power = 0;
+    uint32_t power;
+    uint16_t best = 1;
+    uint16_t k;
+
+    for (k = 1; k < half; k++) {
+        int32_t re = ADC_FFT_RE(buffer[k]);
+        int32_t im = ADC_FFT_IM(buffer[k]);
+
+        power = (uint32_t)(re * re) + (uint32_t)(im * im);
+        if (power > best_power) {
+            best_power = power;
+            best = k;
+        }
+    }
+    *amplitude = (uint16_t)(2u * adc_stats_isqrt(best_power));
+    return best;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_fft_benchmark(int32_t *buffer,
+                       uint32_t cycles[ADC_FFT_NR_OF_SIZES])
+{
+    uint32_t x = LCG_SEED;
+    uint32_t start;
+    uint32_t i;
+    uint8_t log2;
+
+    for (log2 = ADC_FFT_MIN_LOG2; log2 <= ADC_FFT_MAX_LOG2; log2++) {
+        for (i = 0; i < (1u << log2); i++) {
+            x = LCG_NEXT(x);
+            buffer[i] = ADC_FFT_PACK((int16_t)(x >> 16), 0);
+        }
+        start = CYCLE_COUNTER;
+        adc_fft_forward(buffer, log2);
+        cycles[log2 - ADC_FFT_MIN_LOG2] = CYCLE_COUNTER - start;
+    }
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static void bit_reverse(int32_t *buffer, uint8_t log2)
+{
+    uint32_t n = 1u << log2;
+    uint32_t i;
+    uint32_t j = 0;
+    uint32_t bit;
+    int32_t swap;
+
+    for (i = 1; i < n; i++) {
+        /* add one to j from the top bit down */
+        for (bit = n >> 1; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            swap = buffer[i];
+            buffer[i] = buffer[j];
+            buffer[j] = swap;
+        }
+    }
+}
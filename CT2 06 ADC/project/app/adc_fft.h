@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_fft.
+ * --
+ * -- In-place radix-4 FFT on Q15 complex values. On a core with the DSP
+ * -- extension (Cortex-M4) the butterflies use the dual 16 bit SIMD
+ * -- instructions, elsewhere the same algorithm runs in portable C.
+ * -- Note: ADC.uvprojx selects the CT board device with CPUTYPE Cortex-M0
+ * -- like all labs of the course, so the Keil build compiles the portable
+ * -- kernels. The SIMD path is only compiled with the target set to
+ * -- Cortex-M4 (Options for Target -> Device/Target).
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_FFT_H
+#define _ADC_FFT_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_FFT_MIN_LOG2    6u          // 64 points
+#define ADC_FFT_MAX_LOG2    10u         // 1024 points
+#define ADC_FFT_MAX_SIZE    (1u << ADC_FFT_MAX_LOG2)
+#define ADC_FFT_NR_OF_SIZES (ADC_FFT_MAX_LOG2 - ADC_FFT_MIN_LOG2 + 1u)
+
+/*
+ * A complex Q15 value in one word: real part in the lower, imaginary part
+ * in the upper half word, as the SIMD instructions expect it.
+ */
+#define ADC_FFT_PACK(re, im) \
+    ((int32_t)(((uint32_t)(uint16_t)(im) << 16) | (uint16_t)(re)))
+#define ADC_FFT_RE(x)       ((int16_t)((uint32_t)(x) & 0xFFFF))
+#define ADC_FFT_IM(x)       ((int16_t)((uint32_t)(x) >> 16))
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Computes the twiddle factors for ADC_FFT_MAX_SIZE, call once.
+ */
+void adc_fft_init(void);
+
+/*
+ * Removes the mean of 'nr_of_points' samples with 'bits' valid bits and
+ * stores them scaled to Q15 as real values into 'buffer'.
+ */
+void adc_fft_load(int32_t *buffer, const uint16_t *samples,
+                  uint16_t nr_of_points, uint8_t bits);
+
+/*
+ * Forward FFT of 2^log2 points (ADC_FFT_MIN_LOG2 .. ADC_FFT_MAX_LOG2) in
+ * place. Radix-4 stages, plus one radix-2 stage for odd log2. Every
+ * stage scales by 1/radix, so the result is X[k] / N and cannot
+ * overflow. The result is in natural order.
+ */
+void adc_fft_forward(int32_t *buffer, uint8_t log2);
+
+/*
+ * Searches bins 1 .. N/2 - 1 of a transformed buffer for the largest
+ * magnitude. Returns the bin and stores the amplitude of the
+ * corresponding sine in Q15 of full scale (2 |X[k]| / N) in 'amplitude'.
+ */
+uint16_t adc_fft_peak(const int32_t *buffer, uint8_t log2,
+                      uint16_t *amplitude);
+
+/*
+ * Times adc_fft_forward() for every size from 2^ADC_FFT_MIN_LOG2 to
+ * 2^ADC_FFT_MAX_LOG2 points on pseudo random samples and stores the
+ * cycles in 'cycles', index 0 = the smallest size. 'buffer' holds
+ * ADC_FFT_MAX_SIZE values and is overwritten.
+ */
+void adc_fft_benchmark(int32_t *buffer,
+                       uint32_t cycles[ADC_FFT_NR_OF_SIZES]);
+
+#endif
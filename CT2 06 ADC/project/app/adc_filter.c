@@ -0,0 +1,244 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_filter.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_filter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* 12 bit samples are scaled to Q31 by a shift of 19 */
+#define Q31_SHIFT          19
+
+/*
+ * Butterworth low-pass, fc = fs / 50, coefficients in Q30 (|a1| > 1).
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ */
+#define BIQUAD_B0          ((int32_t)3888751)
+#define BIQUAD_B1          ((int32_t)7777502)
+#define BIQUAD_B2          ((int32_t)3888751)
+#define BIQUAD_A1          ((int32_t)1957103774)
+#define BIQUAD_A2          ((int32_t)-898916953)
+#define BIQUAD_COEF_SHIFT  30
+
+/* CIC gain is R^N = 2^(N * log2(R)) */
+#define CIC_GAIN_SHIFT     (ADC_FILTER_CIC_STAGES * ADC_FILTER_CIC_LOG2_R)
+#define CIC_R_MASK         ((1u << ADC_FILTER_CIC_LOG2_R) - 1u)
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static uint16_t ema_process(adc_filter_t *filter, uint16_t adc_value);
+static uint16_t biquad_process(adc_filter_t *filter, uint16_t adc_value);
+static uint32_t cic_process(adc_filter_t *filter, uint16_t adc_value,
+                            uint16_t *output);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_filter_init(adc_filter_t *filter, adc_filter_type_t type)
+{
+    uint8_t i;
+
+    filter->type = type;
+    switch (type) {
+        case ADC_FILTER_BOXCAR:
+            filter->state.boxcar.avg.buffer = filter->state.boxcar.buffer;
+            filter->state.boxcar.avg.mask =
+                (1u << ADC_FILTER_BOXCAR_LOG2) - 1u;
+            filter->state.boxcar.avg.shift = ADC_FILTER_BOXCAR_LOG2;
+            adc_avg_reset(&filter->state.boxcar.avg);
+            break;
+        case ADC_FILTER_EMA:
+            filter->state.ema.y = 0;
+            break;
+        case ADC_FILTER_BIQUAD:
+            filter->state.biquad.x1 = 0;
+            filter->state.biquad.x2 = 0;
+            filter->state.biquad.y1 = 0;
+            filter->state.biquad.y2 = 0;
+            break;
+        case ADC_FILTER_CIC:
+            for (i = 0; i < ADC_FILTER_CIC_STAGES; i++) {
+                filter->state.cic.integrator[i] = 0;
+                filter->state.cic.comb[i] = 0;
+            }
+            filter->state.cic.count = 0;
+            break;
+        case ADC_FILTER_MEDIAN:
+            adc_median_init(&filter->state.median, ADC_FILTER_MEDIAN_LENGTH);
+            break;
+        default:
+            filter->type = ADC_FILTER_NONE;
+            break;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+uint32_t adc_filter_process(adc_filter_t *filter, uint16_t adc_value,
+                            uint16_t *output)
+{
+    switch (filter->type) {
+        case ADC_FILTER_BOXCAR:
+            *output = adc_avg_update(&filter->state.boxcar.avg, adc_value);
+            return 1;
+        case ADC_FILTER_EMA:
+            *output = ema_process(filter, adc_value);
+            return 1;
+        case ADC_FILTER_BIQUAD:
+            *output = biquad_process(filter, adc_value);
+            return 1;
+        case ADC_FILTER_CIC:
+            return cic_process(filter, adc_value, output);
+        case ADC_FILTER_MEDIAN:
+            *output = adc_median_update(&filter->state.median, adc_value);
+            return 1;
+        default:
+            *output = adc_value;
+            return 1;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void adc_oversample_init(adc_oversample_t *oversample, uint8_t extra_bits)
+{
+    if (extra_bits < 1) {
+        extra_bits = 1;
+    } else if (extra_bits > ADC_OVERSAMPLE_MAX_BITS) {
+        extra_bits = ADC_OVERSAMPLE_MAX_BITS;
+    }
+    oversample->extra_bits = extra_bits;
+    oversample->count = 0;
+    oversample->sum = 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint32_t adc_oversample_process(adc_oversample_t *oversample,
+                                uint16_t adc_value, uint16_t *output)
+{
+    uint8_t n = oversample->extra_bits;
+
+    oversample->sum += adc_value;
+    oversample->count++;
+
+    /* 4^n = 2^(2n) samples */
+    if (oversample->count < (1u << (2 * n))) {
+        return 0;
+    }
+    *output = (uint16_t)(oversample->sum >> n);
+    oversample->count = 0;
+    oversample->sum = 0;
+    return 1;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * y += alpha * (x - y), with y and x in Q15.
+ * The product is 64 bit wide (SMULL on the M4).
+ */
+static uint16_t ema_process(adc_filter_t *filter, uint16_t adc_value)
+{
+    int32_t y = filter->state.ema.y;
+    int32_t diff = ((int32_t)adc_value << 15) - y;
+
+    y += (int32_t)(((int64_t)ADC_FILTER_EMA_ALPHA * diff) >> 15);
+    filter->state.ema.y = y;
+
+    return (uint16_t)((y + (1 << 14)) >> 15);
+}
+
+/*
+ * Direct form I with a 64 bit accumulator (SMLAL on the M4).
+ */
+static uint16_t biquad_process(adc_filter_t *filter, uint16_t adc_value)
+{
+    int32_t x0 = (int32_t)((uint32_t)adc_value << Q31_SHIFT);
+    int64_t acc;
+    int32_t y0;
+
+    acc  = (int64_t)BIQUAD_B0 * x0;
+    acc += (int64_t)BIQUAD_B1 * filter->state.biquad.x1;
+    acc += (int64_t)BIQUAD_B2 * filter->state.biquad.x2;
+    acc += (int64_t)BIQUAD_A1 * filter->state.biquad.y1;
+    acc += (int64_t)BIQUAD_A2 * filter->state.biquad.y2;
+    acc >>= BIQUAD_COEF_SHIFT;
+
+    /* saturate to Q31, overshoot on steps must not wrap around */
+    if (acc > INT32_MAX) {
+        acc = INT32_MAX;
+    } else if (acc < 0) {
+        acc = 0;
+    }
+    y0 = (int32_t)acc;
+
+    filter->state.biquad.x2 = filter->state.biquad.x1;
+    filter->state.biquad.x1 = x0;
+    filter->state.biquad.y2 = filter->state.biquad.y1;
+    filter->state.biquad.y1 = y0;
+
+    return (uint16_t)((y0 + (1 << (Q31_SHIFT - 1))) >> Q31_SHIFT);
+}
+
+/*
+ * Integrators run at the input rate, combs (differential delay 1) at the
+ * output rate. The arithmetic is modulo 2^32, the wrap around of the
+ * integrators cancels in the combs as long as the output fits 32 bit.
+ */
+static uint32_t cic_process(adc_filter_t *filter, uint16_t adc_value,
+                            uint16_t *output)
+{
+    uint32_t value = adc_value;
+    uint32_t previous;
+    uint8_t i;
+
+    for (i = 0; i < ADC_FILTER_CIC_STAGES; i++) {
+        filter->state.cic.integrator[i] += value;
+        value = filter->state.cic.integrator[i];
+    }
+
+    filter->state.cic.count = (filter->state.cic.count + 1u) & CIC_R_MASK;
+    if (filter->state.cic.count != 0) {
+        return 0;
+    }
+
+    for (i = 0; i < ADC_FILTER_CIC_STAGES; i++) {
+        previous = filter->state.cic.comb[i];
+        filter->state.cic.comb[i] = value;
+        value -= previous;
+    }
+    *output = (uint16_t)(value >> CIC_GAIN_SHIFT);
+    return 1;
+}
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_filter.
+ * --
+ * -- Bank of fixed point filters for adc samples behind one interface.
+ * -- The samples are right aligned unsigned values of up to 12 bit.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_FILTER_H
+#define _ADC_FILTER_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc.h"
+#include "adc_median.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_FILTER_BOXCAR_LOG2  4u          // 16 taps
+#define ADC_FILTER_EMA_ALPHA    0x0800      // Q15: 1/16
+#define ADC_FILTER_CIC_STAGES   3u
+#define ADC_FILTER_CIC_LOG2_R   4u          // decimation by 16
+#define ADC_FILTER_MEDIAN_LENGTH 15u        // default, see adc_median_init()
+
+#define ADC_OVERSAMPLE_MAX_BITS 4u          // 12 + 4 = 16 bit
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef enum {
+    ADC_FILTER_NONE = 0,
+    ADC_FILTER_BOXCAR = 1,      // moving average over 16 samples
+    ADC_FILTER_EMA = 2,         // exponential moving average, Q15
+    ADC_FILTER_BIQUAD = 3,      // 2nd order butterworth low-pass, Q31
+    ADC_FILTER_CIC = 4,         // 3 stage CIC decimator, R = 16
+    ADC_FILTER_MEDIAN = 5       // sliding median, removes spikes
+} adc_filter_type_t;
+
+typedef struct {
+    adc_filter_type_t type;
+    union {
+        struct {
+            adc_avg_t avg;
+            uint16_t buffer[1u << ADC_FILTER_BOXCAR_LOG2];
+        } boxcar;
+        struct {
+            int32_t y;              // output in Q15 (value << 15)
+        } ema;
+        struct {
+            int32_t x1, x2;         // input history in Q31
+            int32_t y1, y2;         // output history in Q31
+        } biquad;
+        struct {
+            uint32_t integrator[ADC_FILTER_CIC_STAGES];
+            uint32_t comb[ADC_FILTER_CIC_STAGES];
+            uint16_t count;
+        } cic;
+        adc_median_t median;
+    } state;
+} adc_filter_t;
+
+/*
+ * Oversample and decimate: 4^n samples are summed and the sum is shifted
+ * right by n, which gives n additional bits. This works only if the input
+ * carries at least about 1 LSB of white noise (dither).
+ */
+typedef struct {
+    uint8_t extra_bits;     // n
+    uint16_t count;         // samples summed so far
+    uint32_t sum;
+} adc_oversample_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Selects the filter 'type' for 'filter' and clears its state.
+ * The median starts with ADC_FILTER_MEDIAN_LENGTH, call adc_median_init()
+ * on state.median for another window length.
+ */
+void adc_filter_init(adc_filter_t *filter, adc_filter_type_t type);
+
+/*
+ * Feeds adc_value into 'filter'.
+ * Returns 1 and writes the filtered value to 'output' if the filter
+ * produced an output, 0 otherwise. All filters produce an output for every
+ * sample except the CIC decimator, which produces one every 16 samples.
+ */
+uint32_t adc_filter_process(adc_filter_t *filter, uint16_t adc_value,
+                            uint16_t *output);
+
+/*
+ * Sets the number of additional bits 'extra_bits' (1 up to
+ * ADC_OVERSAMPLE_MAX_BITS, larger values are limited) of 'oversample' and
+ * clears its state.
+ */
+void adc_oversample_init(adc_oversample_t *oversample, uint8_t extra_bits);
+
+/*
+ * Feeds adc_value into 'oversample'.
+ * Returns 1 and writes the value with extra_bits additional bits to
+ * 'output' after every 4^extra_bits samples, 0 otherwise.
+ */
+uint32_t adc_oversample_process(adc_oversample_t *oversample,
+                                uint16_t adc_value, uint16_t *output);
+
+#endif
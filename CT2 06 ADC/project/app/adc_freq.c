@@ -0,0 +1,221 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_freq.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_freq.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define FRACTION_BITS       16
+#define FRACTION_ONE        (1u << FRACTION_BITS)
+
+/* 10^9 / 2^16 = 1953125 / 2^7 */
+#define NS_PER_FRACTION_NUM 1953125u
+#define NS_PER_FRACTION_DEN 128u
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void count_crossing(adc_freq_t *meter);
+static void update_level(adc_freq_t *meter);
+static void restart(adc_freq_t *meter);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_freq_init(adc_freq_t *meter, const adc_freq_config_t *config)
+{
+    meter->config = *config;
+    if (meter->config.nr_of_periods == 0) {
+        meter->config.nr_of_periods = 1;
+    } else if (meter->config.nr_of_periods > ADC_FREQ_MAX_PERIODS) {
+        meter->config.nr_of_periods = ADC_FREQ_MAX_PERIODS;
+    }
+    if (meter->config.hysteresis == 0) {
+        meter->config.hysteresis = 1;
+    }
+    meter->level = (uint16_t)(1u << (config->bits - 1u));
+    meter->previous = 0;
+    meter->below = 0;
+    meter->started = 0;
+    meter->index = 0;
+    meter->candidate = 0;
+    meter->candidate_fraction = 0;
+    meter->silence = 0;
+    meter->sum = 0;
+    meter->count = 0;
+    meter->ready = 0;
+    restart(meter);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_freq_process(adc_freq_t *meter, const uint16_t *samples,
+                      uint16_t nr_of_samples)
+{
+    int32_t level = meter->level;
+    int32_t hysteresis = meter->config.hysteresis;
+    int32_t previous = meter->previous;
+    int32_t x;
+    uint32_t fraction;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples; i++) {
+        x = samples[i];
+
+        if (meter->below) {
+            // remember the last level crossing until the hysteresis
+            // confirms it
+            if (previous < level && x >= level) {
+                fraction = ((uint32_t)(level - previous) << FRACTION_BITS)
+                           / (uint32_t)(x - previous);
+                if (fraction >= FRACTION_ONE) {
+                    meter->candidate = meter->index;   // x == level
+                    meter->candidate_fraction = 0;
+                } else {
+                    meter->candidate = meter->index - 1u;
+                    meter->candidate_fraction = (uint16_t)fraction;
+                }
+            }
+            if (x >= level + hysteresis) {
+                meter->below = 0;
+                count_crossing(meter);
+            }
+        } else if (x <= level - hysteresis) {
+            meter->below = 1;
+        }
+        previous = x;
+        meter->index++;
+
+        meter->sum += (uint32_t)x;
+        if (++meter->count >= meter->config.sample_rate_hz) {
+            update_level(meter);
+            level = meter->level;
+        }
+
+        // no signal: report 0 Hz
+        if (++meter->silence >= meter->config.sample_rate_hz) {
+            if (!meter->ready) {
+                meter->result.frequency_mhz = 0;
+                meter->result.period_ns = 0;
+                meter->result.level = meter->level;
+                meter->result.nr_of_periods = 0;
+                meter->ready = 1;
+            }
+            meter->started = 0;
+            meter->silence = 0;
+        }
+    }
+    meter->previous = (uint16_t)previous;
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_freq_read(adc_freq_t *meter, adc_freq_result_t *result)
+{
+    if (!meter->ready) {
+        return 0;
+    }
+    *result = meter->result;
+    meter->ready = 0;
+    return 1;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * A confirmed rising crossing at 'candidate'. Every 'nr_of_periods'
+ * crossings the time since 'first' gives a result.
+ */
+static void count_crossing(adc_freq_t *meter)
+{
+    uint32_t periods = meter->config.nr_of_periods;
+    uint64_t elapsed;               // samples, Q16
+    uint64_t period;                // samples, Q16
+
+    meter->silence = 0;
+    if (!meter->started) {
+        meter->started = 1;
+        restart(meter);
+        return;
+    }
+    if (++meter->periods < periods) {
+        return;
+    }
+
+    elapsed = ((uint64_t)(meter->candidate - meter->first) << FRACTION_BITS)
+              + meter->candidate_fraction - meter->first_fraction;
+    period = elapsed / periods;
+    if (!meter->ready && period > 0) {
+        meter->result.frequency_mhz = (uint32_t)(
+            (uint64_t)meter->config.sample_rate_hz * 1000u * periods
+            * FRACTION_ONE / elapsed);
+        meter->result.period_ns = (uint32_t)(period * NS_PER_FRACTION_NUM
+            / ((uint64_t)meter->config.sample_rate_hz * NS_PER_FRACTION_DEN));
+        meter->result.level = meter->level;
+        meter->result.nr_of_periods = (uint16_t)periods;
+        meter->ready = 1;
+    }
+    restart(meter);
+}
+
+
+/*
+ * Once per second: moves the level to the mean of the last second if it
+ * drifted by more than half the hysteresis. Both crossings of a result
+ * must see the same level, so a move restarts the measurement.
+ */
+static void update_level(adc_freq_t *meter)
+{
+    int32_t mean = (int32_t)(meter->sum / meter->count);
+    int32_t drift = mean - meter->level;
+
+    if (drift < 0) {
+        drift = -drift;
+    }
+    if (2 * drift > meter->config.hysteresis) {
+        meter->level = (uint16_t)mean;
+        meter->started = 0;
+    }
+    meter->sum = 0;
+    meter->count = 0;
+}
+
+
+/*
+ * Starts the next measurement at the current crossing
+ */
+static void restart(adc_freq_t *meter)
+{
+    meter->first = meter->candidate;
+    meter->first_fraction = meter->candidate_fraction;
+    meter->periods = 0;
+}
@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_freq.
+ * --
+ * -- Frequency and period meter on rising zero crossings of the adc
+ * -- samples. A crossing of the level counts once the signal was below
+ * -- level - hysteresis and then reaches level + hysteresis, so noise
+ * -- around the level does not add crossings. The crossing time is
+ * -- interpolated linearly between the two samples around the level,
+ * -- which gives a resolution well below one sample period. The level
+ * -- follows the mean of the samples, averaged over one second.
+ * -- Below about 10 samples per period the curvature of the signal between
+ * -- the two samples biases the interpolation by an amount that depends on
+ * -- the sampling phase, up to a few 0.1 % (host/test_freq.c).
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_FREQ_H
+#define _ADC_FREQ_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_FREQ_MAX_PERIODS    1024u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    uint16_t nr_of_periods;     // averaged per result, 1 .. 1024
+    uint16_t hysteresis;        // in LSB of the samples, at least 1
+    uint8_t bits;               // resolution of the samples
+} adc_freq_config_t;
+
+typedef struct {
+    uint32_t frequency_mhz;     // 0: no crossing for one second
+    uint32_t period_ns;
+    uint16_t level;             // zero line, in LSB of the samples
+    uint16_t nr_of_periods;
+} adc_freq_result_t;
+
+typedef struct {
+    adc_freq_config_t config;
+    uint16_t level;
+    uint16_t previous;          // last sample
+    uint8_t below;              // signal was below level - hysteresis
+    uint8_t started;            // 'first' holds a crossing
+    uint32_t index;             // number of the next sample, wraps
+    uint32_t candidate;         // sample before the last level crossing
+    uint16_t candidate_fraction;    // 1/65536 sample after 'candidate'
+    uint32_t first;             // crossing at the start of the measurement
+    uint16_t first_fraction;
+    uint16_t periods;           // crossings since 'first'
+    uint32_t silence;           // samples since the last crossing
+    uint64_t sum;               // of the samples for the next level
+    uint32_t count;
+    adc_freq_result_t result;
+    volatile uint8_t ready;     // 'result' not yet read
+} adc_freq_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Starts a new measurement with 'config'. The level starts at mid scale.
+ * 'nr_of_periods' and 'hysteresis' are limited to their ranges.
+ */
+void adc_freq_init(adc_freq_t *meter, const adc_freq_config_t *config);
+
+/*
+ * Feeds 'nr_of_samples' samples to the meter, meant to be called from
+ * the block callback of adc_dma_start().
+ */
+void adc_freq_process(adc_freq_t *meter, const uint16_t *samples,
+                      uint16_t nr_of_samples);
+
+/*
+ * Copies the latest result into 'result'. Returns 0 if there is no new
+ * result since the last call. Results completed before the last one was
+ * read are dropped, so this may be called while adc_freq_process() runs
+ * in an interrupt.
+ */
+uint8_t adc_freq_read(adc_freq_t *meter, adc_freq_result_t *result);
+
+#endif
@@ -0,0 +1,288 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_goertzel.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <math.h>
+
+/* user includes */
+#include "adc_goertzel.h"
+#include "adc_stats.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PI                  3.14159265358979323846
+#define Q31_ONE             2147483647.0
+
+/*
+ * A centered 12 bit sample is below 2^11. With an input scaled by 2^shift
+ * the state is bounded by N * 2^(11 + shift) / sin(w). Keeping it below
+ * 2^29 leaves room for 2 cos(w) s[n-1] and the sums in 32 bit.
+ */
+#define STATE_LIMIT         (1u << 18)      // 2^29 / 2^11
+#define MID_SCALE           2048
+
+/* 2 cos(w) * s with cos(w) in Q31 */
+#define MUL_2COS(c, s)      ((int32_t)(((int64_t)(c) * (s)) >> 30))
+
+/* a present tone stays present down to 3/4 of its threshold */
+#define RELEASE(t)          ((uint16_t)((t) - (t) / 4u))
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void evaluate_block(adc_goertzel_t *bank);
+static void queue_event(adc_goertzel_t *bank, uint8_t detector,
+                        uint8_t present);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+uint8_t adc_goertzel_init(adc_goertzel_t *bank,
+                          const adc_goertzel_config_t *config)
+{
+    uint8_t d;
+    double w;
+    double headroom;
+    int32_t shift = 18;
+
+    bank->config = *config;
+    bank->config.nr_of_detectors = 0;
+    bank->count = 0;
+    bank->sum = 0;
+    bank->energy = 0;
+    bank->present = 0;
+    bank->blocks = 0;
+    bank->head = 0;
+    bank->tail = 0;
+    bank->lost = 0;
+    bank->samples = 0;
+    bank->cycles = 0;
+
+    if (config->nr_of_detectors > ADC_GOERTZEL_MAX_DETECTORS
+            || config->block_length == 0
+            || config->block_length > ADC_GOERTZEL_MAX_LENGTH
+            || config->bits < 6 || config->bits > 12) {
+        return 0;
+    }
+    for (d = 0; d < config->nr_of_detectors; d++) {
+        if (config->tone[d].frequency_hz == 0
+                || 2u * config->tone[d].frequency_hz
+                   >= config->sample_rate_hz) {
+            return 0;
+        }
+        w = 2.0 * PI * config->tone[d].frequency_hz / config->sample_rate_hz;
+        headroom = STATE_LIMIT * sin(w) / config->block_length;
+        if (headroom < 1.0) {
+            return 0;
+        }
+        if (floor(log2(headroom)) < shift) {
+            shift = (int32_t)floor(log2(headroom));
+        }
+        bank->cosine[d] = (int32_t)floor(Q31_ONE * cos(w) + 0.5);
+        bank->s1[d] = 0;
+        bank->s2[d] = 0;
+        bank->amplitude[d] = 0;
+    }
+
+    // samples below 12 bit are scaled up to 12 bit on the way
+    bank->shift = (uint8_t)(shift + 12 - config->bits);
+    bank->offset = MID_SCALE << shift;
+    bank->config.nr_of_detectors = config->nr_of_detectors;
+    return 1;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_goertzel_process(adc_goertzel_t *bank, const uint16_t *samples,
+                          uint16_t nr_of_samples)
+{
+    uint32_t start = CYCLE_COUNTER;
+    uint8_t shift = bank->shift;
+    int32_t offset = bank->offset;
+    uint8_t center = (uint8_t)(12u - bank->config.bits);
+    uint16_t remaining = nr_of_samples;
+    uint16_t chunk;
+    uint16_t i;
+    uint8_t d;
+    int32_t x;
+
+    while (remaining > 0) {
+        chunk = (uint16_t)(bank->config.block_length - bank->count);
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+
+        // detector by detector, the state stays in registers
+        for (d = 0; d < bank->config.nr_of_detectors; d++) {
+            int32_t cosine = bank->cosine[d];
+            int32_t s1 = bank->s1[d];
+            int32_t s2 = bank->s2[d];
+            int32_t s0;
+
+            for (i = 0; i < chunk; i++) {
+                s0 = (((int32_t)samples[i] << shift) - offset) - s2
+                     + MUL_2COS(cosine, s1);
+                s2 = s1;
+                s1 = s0;
+            }
+            bank->s1[d] = s1;
+            bank->s2[d] = s2;
+        }
+
+        // AC power of the block for the share of each tone
+        for (i = 0; i < chunk; i++) {
+            x = ((int32_t)samples[i] << center) - MID_SCALE;
+            bank->sum += x;
+            bank->energy += (uint32_t)(x * x);
+        }
+
+        bank->count += chunk;
+        samples += chunk;
+        remaining -= chunk;
+        if (bank->count == bank->config.block_length) {
+            evaluate_block(bank);
+        }
+    }
+
+    bank->samples += nr_of_samples;
+    bank->cycles += CYCLE_COUNTER - start;
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_goertzel_get_event(adc_goertzel_t *bank,
+                               adc_goertzel_event_t *event)
+{
+    uint32_t tail = bank->tail;
+
+    if (tail == bank->head) {
+        return 0;
+    }
+    *event = bank->event[tail % ADC_GOERTZEL_NR_OF_EVENTS];
+    bank->tail = tail + 1u;
+    return 1;
+}
+
+
+/*
+ *  See header file
+ */
+uint32_t adc_goertzel_cycles_x10(const adc_goertzel_t *bank)
+{
+    uint64_t work = (uint64_t)bank->samples * bank->config.nr_of_detectors;
+
+    if (work == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)bank->cycles * 10u / work);
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * |y|^2 = s[N-1]^2 + s[N-2]^2 - 2 cos(w) s[N-1] s[N-2] is the squared
+ * magnitude of the DFT at w. A sine of amplitude A gives |y| = N A / 2.
+ */
+static void evaluate_block(adc_goertzel_t *bank)
+{
+    uint16_t length = bank->config.block_length;
+    uint8_t scale_shift = (uint8_t)(bank->shift
+                                    - (12u - bank->config.bits));
+    uint64_t scale = (uint64_t)length << scale_shift;
+    uint64_t ac = bank->energy
+                  - (uint64_t)((int64_t)bank->sum * bank->sum / length);
+    const adc_goertzel_tone_t *tone;
+    uint8_t present = bank->present;
+    uint8_t detected;
+    uint16_t threshold;
+    uint64_t amplitude;
+    int64_t power;
+    uint8_t d;
+
+    for (d = 0; d < bank->config.nr_of_detectors; d++) {
+        int32_t s1 = bank->s1[d];
+        int32_t s2 = bank->s2[d];
+
+        power = (int64_t)s1 * s1 + (int64_t)s2 * s2
+                - (int64_t)MUL_2COS(bank->cosine[d], s2) * s1;
+        if (power < 0) {
+            power = 0;      // rounding with no signal at all
+        }
+        amplitude = ((uint64_t)adc_stats_isqrt((uint64_t)power) * 2u
+                     + scale / 2u) / scale;
+        bank->amplitude[d] = (uint16_t)amplitude;
+
+        tone = &bank->config.tone[d];
+        threshold = tone->threshold;
+        if (present & (1u << d)) {
+            threshold = RELEASE(threshold);
+        }
+        // share in % = 100 (A^2 / 2) / (ac / N)
+        detected = amplitude >= threshold
+                   && (tone->min_share == 0
+                       || 50u * amplitude * amplitude * length
+                          >= (uint64_t)tone->min_share * ac);
+        if (detected != ((present >> d) & 0x1u)) {
+            present ^= (uint8_t)(1u << d);
+            bank->present = present;
+            queue_event(bank, d, detected);
+        }
+
+        bank->s1[d] = 0;
+        bank->s2[d] = 0;
+    }
+
+    bank->count = 0;
+    bank->sum = 0;
+    bank->energy = 0;
+    bank->blocks++;
+}
+
+
+/*
+ * Only called from adc_goertzel_process(), the reader only moves 'tail'.
+ */
+static void queue_event(adc_goertzel_t *bank, uint8_t detector,
+                        uint8_t present)
+{
+    uint32_t head = bank->head;
+    adc_goertzel_event_t *event;
+
+    if (head - bank->tail >= ADC_GOERTZEL_NR_OF_EVENTS) {
+        bank->lost++;
+        return;
+    }
+    event = &bank->event[head % ADC_GOERTZEL_NR_OF_EVENTS];
+    event->block = bank->blocks;
+    event->amplitude = bank->amplitude[detector];
+    event->detector = detector;
+    event->present = present;
+    bank->head = head + 1u;
+}
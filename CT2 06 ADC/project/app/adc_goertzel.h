@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_goertzel.
+ * --
+ * -- Bank of Goertzel detectors in Q31 fixed point. Each detector runs the
+ * -- second order recursion s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2] over a
+ * -- block of N samples and evaluates the power at its frequency once at
+ * -- the end of the block: one multiplication per sample and detector
+ * -- instead of a full FFT when only a few tones matter. A tone that
+ * -- appears or disappears is reported as an event.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_GOERTZEL_H
+#define _ADC_GOERTZEL_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_GOERTZEL_MAX_DETECTORS  8u      // one bit each in 'present'
+#define ADC_GOERTZEL_MAX_LENGTH     4096u
+#define ADC_GOERTZEL_NR_OF_EVENTS   16u     // power of 2
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t frequency_hz;
+    uint16_t threshold;         // minimum amplitude in 12 bit LSB
+    uint8_t min_share;          // minimum share of the AC power in %, 0 = off
+} adc_goertzel_tone_t;
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    uint16_t block_length;      // N, up to ADC_GOERTZEL_MAX_LENGTH
+    uint8_t bits;               // resolution of the samples, 6 to 12
+    uint8_t nr_of_detectors;
+    adc_goertzel_tone_t tone[ADC_GOERTZEL_MAX_DETECTORS];
+} adc_goertzel_config_t;
+
+typedef struct {
+    uint32_t block;             // block number since adc_goertzel_init()
+    uint16_t amplitude;         // 12 bit LSB
+    uint8_t detector;
+    uint8_t present;            // 1: tone appeared, 0: tone disappeared
+} adc_goertzel_event_t;
+
+typedef struct {
+    adc_goertzel_config_t config;
+    int32_t cosine[ADC_GOERTZEL_MAX_DETECTORS];     // cos(w), Q31
+    int32_t s1[ADC_GOERTZEL_MAX_DETECTORS];         // s[n-1]
+    int32_t s2[ADC_GOERTZEL_MAX_DETECTORS];         // s[n-2]
+    uint16_t amplitude[ADC_GOERTZEL_MAX_DETECTORS]; // of the last block
+    uint8_t shift;              // sample -> recursion input
+    int32_t offset;             // mid scale at the recursion input
+    uint16_t count;             // samples of the current block
+    int32_t sum;                // of the centered 12 bit samples
+    uint64_t energy;            // sum of their squares
+    volatile uint8_t present;   // bit per detector
+    volatile uint32_t blocks;
+    adc_goertzel_event_t event[ADC_GOERTZEL_NR_OF_EVENTS];
+    volatile uint32_t head;     // events written
+    volatile uint32_t tail;     // events read
+    volatile uint32_t lost;     // events dropped while the queue was full
+    uint32_t samples;           // processed since adc_goertzel_init()
+    uint32_t cycles;            // spent in adc_goertzel_process()
+} adc_goertzel_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Computes the coefficients for 'config' and empties the bank. Returns 0
+ * and leaves the bank without detectors if the configuration is invalid:
+ * more than ADC_GOERTZEL_MAX_DETECTORS, a block length of 0 or above
+ * ADC_GOERTZEL_MAX_LENGTH, or a frequency so close to 0 or to the
+ * Nyquist frequency that the recursion would overflow.
+ */
+uint8_t adc_goertzel_init(adc_goertzel_t *bank,
+                          const adc_goertzel_config_t *config);
+
+/*
+ * Feeds 'nr_of_samples' samples to all detectors, meant to be called from
+ * the block callback of adc_dma_start(). Blocks of the bank do not have
+ * to line up with the DMA blocks. At the end of each bank block the
+ * amplitudes are updated and the events are queued.
+ */
+void adc_goertzel_process(adc_goertzel_t *bank, const uint16_t *samples,
+                          uint16_t nr_of_samples);
+
+/*
+ * Takes the oldest event from the queue. Returns 0 if there is none.
+ * May be called while adc_goertzel_process() runs in an interrupt.
+ */
+uint8_t adc_goertzel_get_event(adc_goertzel_t *bank,
+                               adc_goertzel_event_t *event);
+
+/*
+ * Cycles spent in adc_goertzel_process() per sample and detector in
+ * 1/10, including the block evaluation.
+ */
+uint32_t adc_goertzel_cycles_x10(const adc_goertzel_t *bank);
+
+#endif
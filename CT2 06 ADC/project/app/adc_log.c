@@ -0,0 +1,208 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_log.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_log.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define LOG_MEMORY          ((volatile uint8_t *)ADC_LOG_BASE)
+#define BLOCK_ADDRESS(b)    (LOG_MEMORY + (uint32_t)(b) * ADC_LOG_BLOCK_SIZE)
+
+/* zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ... */
+#define ZIGZAG(d)           (((uint32_t)(d) << 1) ^ (uint32_t)((d) >> 31))
+#define UNZIGZAG(z)         ((int32_t)((z) >> 1) ^ -(int32_t)((z) & 0x1u))
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void start_block(adc_log_t *log, uint16_t block, uint32_t sequence);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_log_init(adc_log_t *log)
+{
+    uint16_t block;
+
+    for (block = 0; block < ADC_LOG_NR_OF_BLOCKS; block++) {
+        log->index[block].first_sequence = 0;
+        log->index[block].nr_of_samples = 0;
+        log->index[block].used = 0;
+    }
+    log->next_sequence = 0;
+    log->oldest_sequence = 0;
+    log->head = 0;
+    log->previous = 0;
+    log->bytes_written = 0;
+    log->write_cycles = 0;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_log_write(adc_log_t *log, const uint16_t *samples,
+                   uint16_t nr_of_samples)
+{
+    uint32_t start = CYCLE_COUNTER;
+    adc_log_block_t *head = &log->index[log->head];
+    volatile uint8_t *memory = BLOCK_ADDRESS(log->head);
+    uint16_t previous = log->previous;
+    uint16_t used = head->used;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples; i++) {
+        int32_t delta = (int32_t)samples[i] - previous;
+        uint32_t code = ZIGZAG(delta);
+
+        if (used > ADC_LOG_BLOCK_SIZE - ADC_LOG_MAX_CODE_SIZE) {
+            head->used = used;
+            log->bytes_written += used;
+            log->head = (log->head + 1u) % ADC_LOG_NR_OF_BLOCKS;
+            start_block(log, log->head, log->next_sequence + i);
+            head = &log->index[log->head];
+            memory = BLOCK_ADDRESS(log->head);
+            used = 0;
+            code = ZIGZAG((int32_t)samples[i]);     // chain restarts at 0
+        }
+
+        while (code >= 0x80u) {
+            memory[used++] = (uint8_t)(code | 0x80u);
+            code >>= 7;
+        }
+        memory[used++] = (uint8_t)code;
+
+        previous = samples[i];
+        head->nr_of_samples++;
+    }
+
+    head->used = used;
+    log->previous = previous;
+    log->next_sequence += nr_of_samples;
+    log->write_cycles += CYCLE_COUNTER - start;
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_log_read(const adc_log_t *log, uint32_t sequence,
+                      uint16_t *samples, uint16_t max_samples)
+{
+    uint16_t block = log->head;
+    uint16_t count = 0;
+    uint16_t n;
+    uint16_t i;
+
+    if (sequence < log->oldest_sequence || sequence >= log->next_sequence) {
+        return 0;
+    }
+
+    /* Seek backwards from the head block, at most NR_OF_BLOCKS steps */
+    for (n = 0; n < ADC_LOG_NR_OF_BLOCKS; n++) {
+        if (log->index[block].first_sequence <= sequence) {
+            break;
+        }
+        block = (block + ADC_LOG_NR_OF_BLOCKS - 1u) % ADC_LOG_NR_OF_BLOCKS;
+    }
+
+    /* Decode block by block towards the head */
+    while (count < max_samples) {
+        const adc_log_block_t *entry = &log->index[block];
+        volatile uint8_t *memory = BLOCK_ADDRESS(block);
+        uint32_t current = entry->first_sequence;
+        uint16_t nr_of_samples = entry->nr_of_samples;
+        uint16_t position = 0;
+        uint16_t value = 0;
+
+        for (i = 0; i < nr_of_samples && count < max_samples; i++) {
+            uint32_t code = 0;
+            uint8_t shift = 0;
+            uint8_t byte;
+
+            do {
+                byte = memory[position++];
+                code |= (uint32_t)(byte & 0x7Fu) << shift;
+                shift += 7;
+            } while (byte & 0x80u);
+            value = (uint16_t)(value + UNZIGZAG(code));
+
+            if (current + i >= sequence) {
+                samples[count++] = value;
+            }
+        }
+
+        if (block == log->head) {
+            break;
+        }
+        block = (block + 1u) % ADC_LOG_NR_OF_BLOCKS;
+    }
+
+    /* The writer dropped the first block meanwhile: data not valid */
+    if (sequence < log->oldest_sequence) {
+        return 0;
+    }
+    return count;
+}
+
+
+/*
+ *  See header file
+ */
+void adc_log_statistics(const adc_log_t *log, uint32_t *ratio_x100,
+                        uint32_t *samples_per_s)
+{
+    uint32_t bytes = log->bytes_written + log->index[log->head].used;
+    uint32_t samples = log->next_sequence;
+
+    *ratio_x100 = (bytes == 0) ? 0 :
+                  (uint32_t)((uint64_t)samples * 2u * 100u / bytes);
+    *samples_per_s = (log->write_cycles == 0) ? 0 :
+                     (uint32_t)((uint64_t)samples * CPU_CLOCK_HZ
+                                / log->write_cycles);
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Empties 'block' for the samples from 'sequence' on. If it held the
+ * oldest samples, the oldest sequence moves on first, so that a reader
+ * notices.
+ */
+static void start_block(adc_log_t *log, uint16_t block, uint32_t sequence)
+{
+    adc_log_block_t *entry = &log->index[block];
+
+    if (entry->nr_of_samples != 0) {
+        log->oldest_sequence = entry->first_sequence + entry->nr_of_samples;
+    }
+    entry->first_sequence = sequence;
+    entry->nr_of_samples = 0;
+    entry->used = 0;
+}
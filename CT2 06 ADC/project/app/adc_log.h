@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_log.
+ * --
+ * -- Circular log of samples in the external SRAM. Each sample is stored
+ * -- as the difference to its predecessor, zigzag and varint encoded
+ * -- (7 bit per byte), so a slowly changing signal needs one byte instead
+ * -- of two. The log is split into blocks; each block restarts the delta
+ * -- chain and has an entry in an index in internal RAM for seeking.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_LOG_H
+#define _ADC_LOG_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_capture.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/*
+ * The log shares the external SRAM with adc_capture_burst(), a burst
+ * overwrites the log. adc_capture_init() sets up the FMC.
+ */
+#define ADC_LOG_BASE            ADC_CAPTURE_BASE
+#define ADC_LOG_SIZE            ADC_CAPTURE_SIZE
+
+#define ADC_LOG_BLOCK_SIZE      128u
+#define ADC_LOG_NR_OF_BLOCKS    (ADC_LOG_SIZE / ADC_LOG_BLOCK_SIZE)
+
+/* A 16 bit delta needs at most 17 bit -> 3 bytes */
+#define ADC_LOG_MAX_CODE_SIZE   3u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t first_sequence;    // sequence number of the first sample
+    uint16_t nr_of_samples;
+    uint16_t used;              // bytes
+} adc_log_block_t;
+
+typedef struct {
+    adc_log_block_t index[ADC_LOG_NR_OF_BLOCKS];
+    volatile uint32_t next_sequence;    // number of samples ever written
+    volatile uint32_t oldest_sequence;  // first sample still in the log
+    uint16_t head;                      // block being written
+    uint16_t previous;                  // last sample of the head block
+    uint32_t bytes_written;             // since adc_log_init()
+    uint32_t write_cycles;              // spent in adc_log_write()
+} adc_log_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Empties the log.
+ */
+void adc_log_init(adc_log_t *log);
+
+/*
+ * Appends 'nr_of_samples' samples, meant to be called from the block
+ * callback of adc_dma_start(). When the log is full, the oldest block is
+ * dropped.
+ */
+void adc_log_write(adc_log_t *log, const uint16_t *samples,
+                   uint16_t nr_of_samples);
+
+/*
+ * Copies up to 'max_samples' samples starting at 'sequence' into
+ * 'samples' and returns the number of samples copied. Seeks with the
+ * index to the block that holds 'sequence' and decodes from its start.
+ * Returns 0 if 'sequence' is not (or no longer) in the log. May be called
+ * while adc_log_write() runs in an interrupt: if the writer overwrote
+ * the samples meanwhile, 0 is returned.
+ */
+uint16_t adc_log_read(const adc_log_t *log, uint32_t sequence,
+                      uint16_t *samples, uint16_t max_samples);
+
+/*
+ * Compression ratio (raw 16 bit size / log size) in 1/100 and the
+ * sustained write rate of adc_log_write() in samples per second.
+ */
+void adc_log_statistics(const adc_log_t *log, uint32_t *ratio_x100,
+                        uint32_t *samples_per_s);
+
+#endif
@@ -0,0 +1,296 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_median.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_median.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define UPPER_FLAG      0x8000u
+#define POSITION_MASK   0x7FFFu
+
+/* Numerical Recipes LCG, the top 12 bits are the sample */
+#define LCG_NEXT(x)     ((x) * 1664525u + 1013904223u)
+#define LCG_SEED        12345u
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+/* Benchmark only */
+static adc_median_t bench_median;
+static uint16_t bench_output[ADC_MEDIAN_BENCH_SAMPLES];
+static uint16_t bench_window[ADC_MEDIAN_MAX_LENGTH];
+static uint16_t bench_sorted[ADC_MEDIAN_MAX_LENGTH];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void lower_up(adc_median_t *m, uint16_t i);
+static void lower_down(adc_median_t *m, uint16_t i);
+static void upper_up(adc_median_t *m, uint16_t i);
+static void upper_down(adc_median_t *m, uint16_t i);
+static uint16_t sorted_median(uint16_t length);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_median_init(adc_median_t *median, uint16_t length)
+{
+    if (length == 0) {
+        length = 1;
+    } else if (length > ADC_MEDIAN_MAX_LENGTH) {
+        length = ADC_MEDIAN_MAX_LENGTH;
+    }
+    median->length = length;
+    median->count = 0;
+    median->oldest = 0;
+    median->lower_size = 0;
+    median->upper_size = 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_median_update(adc_median_t *median, uint16_t adc_value)
+{
+    adc_median_t *m = median;
+    uint16_t slot;
+    uint16_t position;
+
+    if (m->count < m->length) {
+        /* Filling: slots in order, the lower heap gets the odd samples */
+        slot = m->count++;
+        m->sample[slot] = adc_value;
+        if (m->lower_size == m->upper_size) {
+            m->lower[m->lower_size] = slot;
+            m->position[slot] = m->lower_size;
+            lower_up(m, m->lower_size++);
+        } else {
+            m->upper[m->upper_size] = slot;
+            m->position[slot] = m->upper_size | UPPER_FLAG;
+            upper_up(m, m->upper_size++);
+        }
+    } else {
+        /* Full: the new sample takes the place of the oldest one */
+        slot = m->oldest;
+        m->oldest = (slot + 1u == m->length) ? 0 : slot + 1u;
+        m->sample[slot] = adc_value;
+        position = m->position[slot];
+        if (position & UPPER_FLAG) {
+            upper_up(m, position & POSITION_MASK);
+            upper_down(m, m->position[slot] & POSITION_MASK);
+        } else {
+            lower_up(m, position);
+            lower_down(m, m->position[slot]);
+        }
+    }
+
+    /* Only the changed sample can be on the wrong side */
+    if (m->upper_size != 0
+            && m->sample[m->lower[0]] > m->sample[m->upper[0]]) {
+        uint16_t low = m->lower[0];
+        uint16_t high = m->upper[0];
+
+        m->lower[0] = high;
+        m->position[high] = 0;
+        m->upper[0] = low;
+        m->position[low] = UPPER_FLAG;
+        lower_down(m, 0);
+        upper_down(m, 0);
+    }
+
+    if (m->lower_size != m->upper_size) {
+        return m->sample[m->lower[0]];
+    }
+    return (uint16_t)(((uint32_t)m->sample[m->lower[0]]
+                       + m->sample[m->upper[0]]) >> 1);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_median_benchmark(uint16_t length, adc_median_report_t *report)
+{
+    uint32_t x = LCG_SEED;
+    uint32_t mismatches = 0;
+    uint32_t start;
+    uint16_t oldest = 0;
+    uint16_t i;
+
+    adc_median_init(&bench_median, length);
+    length = bench_median.length;
+    report->length = length;
+
+    /* Fill the window of both, not timed */
+    for (i = 0; i < length; i++) {
+        x = LCG_NEXT(x);
+        (void)adc_median_update(&bench_median, (uint16_t)(x >> 20));
+        bench_window[i] = (uint16_t)(x >> 20);
+    }
+
+    start = CYCLE_COUNTER;
+    for (i = 0; i < ADC_MEDIAN_BENCH_SAMPLES; i++) {
+        x = LCG_NEXT(x);
+        bench_output[i] = adc_median_update(&bench_median, (uint16_t)(x >> 20));
+    }
+    report->cycles_heap = (CYCLE_COUNTER - start) / ADC_MEDIAN_BENCH_SAMPLES;
+
+    /* Same sequence once more for the baseline */
+    x = LCG_SEED;
+    for (i = 0; i < length; i++) {
+        x = LCG_NEXT(x);
+    }
+    start = CYCLE_COUNTER;
+    for (i = 0; i < ADC_MEDIAN_BENCH_SAMPLES; i++) {
+        x = LCG_NEXT(x);
+        bench_window[oldest] = (uint16_t)(x >> 20);
+        oldest = (oldest + 1u == length) ? 0 : oldest + 1u;
+        if (sorted_median(length) != bench_output[i]) {
+            mismatches++;
+        }
+    }
+    report->cycles_sort = (CYCLE_COUNTER - start) / ADC_MEDIAN_BENCH_SAMPLES;
+    report->mismatches = mismatches;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Sift operations, i is a heap index. Children of i are 2i+1 and 2i+2.
+ * Every move also updates 'position' of the moved slot.
+ */
+static void lower_up(adc_median_t *m, uint16_t i)
+{
+    uint16_t slot = m->lower[i];
+    uint16_t value = m->sample[slot];
+
+    while (i > 0) {
+        uint16_t parent = (uint16_t)((i - 1u) >> 1);
+
+        if (m->sample[m->lower[parent]] >= value) {
+            break;
+        }
+        m->lower[i] = m->lower[parent];
+        m->position[m->lower[i]] = i;
+        i = parent;
+    }
+    m->lower[i] = slot;
+    m->position[slot] = i;
+}
+
+static void lower_down(adc_median_t *m, uint16_t i)
+{
+    uint16_t slot = m->lower[i];
+    uint16_t value = m->sample[slot];
+    uint16_t child;
+
+    while ((child = (uint16_t)(2u * i + 1u)) < m->lower_size) {
+        if (child + 1u < m->lower_size
+                && m->sample[m->lower[child + 1u]]
+                   > m->sample[m->lower[child]]) {
+            child++;
+        }
+        if (m->sample[m->lower[child]] <= value) {
+            break;
+        }
+        m->lower[i] = m->lower[child];
+        m->position[m->lower[i]] = i;
+        i = child;
+    }
+    m->lower[i] = slot;
+    m->position[slot] = i;
+}
+
+static void upper_up(adc_median_t *m, uint16_t i)
+{
+    uint16_t slot = m->upper[i];
+    uint16_t value = m->sample[slot];
+
+    while (i > 0) {
+        uint16_t parent = (uint16_t)((i - 1u) >> 1);
+
+        if (m->sample[m->upper[parent]] <= value) {
+            break;
+        }
+        m->upper[i] = m->upper[parent];
+        m->position[m->upper[i]] = i | UPPER_FLAG;
+        i = parent;
+    }
+    m->upper[i] = slot;
+    m->position[slot] = i | UPPER_FLAG;
+}
+
+static void upper_down(adc_median_t *m, uint16_t i)
+{
+    uint16_t slot = m->upper[i];
+    uint16_t value = m->sample[slot];
+    uint16_t child;
+
+    while ((child = (uint16_t)(2u * i + 1u)) < m->upper_size) {
+        if (child + 1u < m->upper_size
+                && m->sample[m->upper[child + 1u]]
+                   < m->sample[m->upper[child]]) {
+            child++;
+        }
+        if (m->sample[m->upper[child]] >= value) {
+            break;
+        }
+        m->upper[i] = m->upper[child];
+        m->position[m->upper[i]] = i | UPPER_FLAG;
+        i = child;
+    }
+    m->upper[i] = slot;
+    m->position[slot] = i | UPPER_FLAG;
+}
+
+/*
+ * Baseline: copies the benchmark window, sorts it with insertion sort and
+ * picks the middle, same rounding as adc_median_update()
+ */
+static uint16_t sorted_median(uint16_t length)
+{
+    uint16_t i;
+    uint16_t j;
+
+    for (i = 0; i < length; i++) {
+        uint16_t value = bench_window[i];
+
+        for (j = i; j > 0 && bench_sorted[j - 1u] > value; j--) {
+            bench_sorted[j] = bench_sorted[j - 1u];
+        }
+        bench_sorted[j] = value;
+    }
+
+    if (length & 0x1u) {
+        return bench_sorted[length / 2u];
+    }
+    return (uint16_t)(((uint32_t)bench_sorted[length / 2u - 1u]
+                       + bench_sorted[length / 2u]) >> 1);
+}
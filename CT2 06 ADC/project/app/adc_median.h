@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_median.
+ * --
+ * -- Sliding window median over adc samples with two heaps: a max heap
+ * -- holds the lower half of the window, a min heap the upper half, the
+ * -- roots are the middle samples. A new sample overwrites the oldest one
+ * -- in its heap position, so an update is one sift of O(log N) and at
+ * -- most one exchange of the roots. Nothing is ever re-sorted.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_MEDIAN_H
+#define _ADC_MEDIAN_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_MEDIAN_MAX_LENGTH   1023u
+#define ADC_MEDIAN_LOWER_SIZE   ((ADC_MEDIAN_MAX_LENGTH + 1u) / 2u)
+#define ADC_MEDIAN_UPPER_SIZE   (ADC_MEDIAN_MAX_LENGTH / 2u)
+
+/* Timed samples of adc_median_benchmark() after the window is full */
+#define ADC_MEDIAN_BENCH_SAMPLES 64u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Window of up to ADC_MEDIAN_MAX_LENGTH samples, about 6 kB.
+ * The heaps hold slot numbers of 'sample', 'position' maps a slot back to
+ * its place in one of the heaps.
+ */
+typedef struct {
+    uint16_t length;                            // window length N
+    uint16_t count;                             // samples so far, up to N
+    uint16_t oldest;                            // slot of the next update
+    uint16_t lower_size;                        // count - count / 2
+    uint16_t upper_size;                        // count / 2
+    uint16_t sample[ADC_MEDIAN_MAX_LENGTH];     // circular buffer
+    uint16_t position[ADC_MEDIAN_MAX_LENGTH];   // bit 15 set: upper heap
+    uint16_t lower[ADC_MEDIAN_LOWER_SIZE];      // max heap, <= median
+    uint16_t upper[ADC_MEDIAN_UPPER_SIZE];      // min heap, >= median
+} adc_median_t;
+
+/* Two heap update against copying and sorting the window per sample */
+typedef struct {
+    uint16_t length;
+    uint32_t cycles_heap;       // per sample
+    uint32_t cycles_sort;       // per sample
+    uint32_t mismatches;        // outputs that differ, 0 expected
+} adc_median_report_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Empties 'median' and sets the window length to 'length' (1 up to
+ * ADC_MEDIAN_MAX_LENGTH, other values are limited).
+ */
+void adc_median_init(adc_median_t *median, uint16_t length);
+
+/*
+ * Replaces the oldest sample of the window by adc_value and returns the
+ * median of the window. While the window fills up the median of the
+ * samples so far is returned. For an even number of samples it is the
+ * mean of the two middle samples, rounded down.
+ */
+uint16_t adc_median_update(adc_median_t *median, uint16_t adc_value);
+
+/*
+ * Runs pseudo random 12 bit samples through a window of 'length' with
+ * adc_median_update() and with a copy and insertion sort of the window
+ * per sample, and reports the cycles per sample of both over
+ * ADC_MEDIAN_BENCH_SAMPLES samples after the window is full.
+ * Takes up to about 1 s at length 1023.
+ */
+void adc_median_benchmark(uint16_t length, adc_median_report_t *report);
+
+#endif
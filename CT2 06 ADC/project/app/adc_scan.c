@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_scan.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <reg_stm32f4xx.h>
+
+/* user includes */
+#include "adc_scan.h"
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PERIPH_DMA2_ENABLE  (0x00400000)
+#define PERIPH_ADC1_ENABLE  (0x00000100)
+
+#define CHANNEL_POT1        4u
+#define CHANNEL_VREFINT     17u
+#define CHANNEL_TEMP_VBAT   18u
+
+/* ADC common control */
+#define CCR_VBATE           (0x1 << 22)
+#define CCR_TSVREFE         (0x1 << 23)
+
+#define ADC_SR_JEOC         (0x1 << 2)
+#define ADC_CR1_SCAN        (0x1 << 8)
+#define ADC_CR2_ADON        (0x1 << 0)
+#define ADC_CR2_DMA         (0x1 << 8)
+#define ADC_CR2_JSWSTART    (0x1 << 22)
+#define ADC_CR2_SWSTART     (0x1 << 30)
+
+/* Regular sequence of ADC1: length 2, VREFINT then temperature sensor */
+#define ADC1_SQR1_LENGTH    ((2u - 1u) << 20)
+#define ADC1_SQR3_SEQUENCE  (CHANNEL_VREFINT | (CHANNEL_TEMP_VBAT << 5))
+#define NR_OF_REGULAR       2u
+
+/* Injected sequence of length 1 uses JSQ4 */
+#define JSQR_SINGLE(ch)     ((uint32_t)(ch) << 15)
+
+/* 480 cycles for channels 17 and 18, temperature sensor needs >= 10 us */
+#define ADC1_SMPR1_INTERNAL ((0x7 << 21) | (0x7 << 24))
+
+/* Startup times: ADC 3 us, temperature sensor and VREFINT 10 us */
+#define ADC_STARTUP_CYCLES  (CPU_CLOCK_HZ / 1000000u * 3u)
+#define TS_STARTUP_CYCLES   (CPU_CLOCK_HZ / 1000000u * 10u)
+
+/* DMA2 stream 4 channel 0 is connected to ADC1 */
+#define DMA2_BASE           (0x40026400)
+#define DMA2_HISR           (*((volatile uint32_t *)(DMA2_BASE + 0x04)))
+#define DMA2_HIFCR          (*((volatile uint32_t *)(DMA2_BASE + 0x0C)))
+#define DMA2_S4CR           (*((volatile uint32_t *)(DMA2_BASE + 0x70)))
+#define DMA2_S4NDTR         (*((volatile uint32_t *)(DMA2_BASE + 0x74)))
+#define DMA2_S4PAR          (*((volatile uint32_t *)(DMA2_BASE + 0x78)))
+#define DMA2_S4M0AR         (*((volatile uint32_t *)(DMA2_BASE + 0x7C)))
+#define DMA2_S4FCR          (*((volatile uint32_t *)(DMA2_BASE + 0x84)))
+
+#define DMA_S4_TEIF         (0x1 << 3)
+#define DMA_S4_TCIF         (0x1 << 5)
+#define DMA_S4_ALL_FLAGS    (0x3D)
+
+#define DMA_CR_EN           (0x1 << 0)
+#define DMA_CR_ADC1         ((0x0 << 25)    /* CHSEL = 0 -> ADC1        */ \
+                           | (0x1 << 13)    /* MSIZE = 16 bit           */ \
+                           | (0x1 << 11)    /* PSIZE = 16 bit           */ \
+                           | (0x1 << 10))   /* MINC, per -> mem         */
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static volatile uint16_t regular[NR_OF_REGULAR];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void wait_cycles(uint32_t cycles);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_scan_init(void)
+{
+    RCC->AHB1ENR |= PERIPH_DMA2_ENABLE;
+    RCC->APB2ENR |= PERIPH_ADC1_ENABLE;
+
+    ADC1->CR2 = ADC_CR2_ADON;
+    ADCCOM->CCR |= CCR_TSVREFE;
+    wait_cycles(TS_STARTUP_CYCLES);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_scan(adc_scan_result_t *result)
+{
+    /* ADC1 and the internal channels are switched on at the first call */
+    if (!(ADC1->CR2 & ADC_CR2_ADON) || !(ADCCOM->CCR & CCR_TSVREFE)) {
+        adc_scan_init();
+    }
+
+    /* POT1: injected conversion on ADC3 */
+    ADC3->SR &= ~ADC_SR_JEOC;
+    ADC3->JSQR = JSQR_SINGLE(CHANNEL_POT1);
+    ADC3->CR2 |= ADC_CR2_JSWSTART;
+
+    /* VREFINT and temperature: regular scan of ADC1 with DMA */
+    DMA2_S4CR = 0;
+    while (DMA2_S4CR & DMA_CR_EN) {}
+    DMA2_HIFCR = DMA_S4_ALL_FLAGS;
+    DMA2_S4PAR = (uint32_t)&ADC1->DR;
+    DMA2_S4M0AR = (uint32_t)regular;
+    DMA2_S4NDTR = NR_OF_REGULAR;
+    DMA2_S4FCR = 0;
+    DMA2_S4CR = DMA_CR_ADC1;
+    DMA2_S4CR |= DMA_CR_EN;
+
+    ADC1->SR = 0;
+    ADC1->CR1 = ADC_CR1_SCAN;
+    ADC1->SMPR1 = ADC1_SMPR1_INTERNAL;
+    ADC1->SQR1 = ADC1_SQR1_LENGTH;
+    ADC1->SQR2 = 0;
+    ADC1->SQR3 = ADC1_SQR3_SEQUENCE;
+    ADC1->CR2 = ADC_CR2_ADON | ADC_CR2_DMA;
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+
+    while (!(DMA2_HISR & (DMA_S4_TCIF | DMA_S4_TEIF))) {}
+    DMA2_HIFCR = DMA_S4_ALL_FLAGS;
+    ADC1->CR2 = ADC_CR2_ADON;
+    result->vrefint = regular[0];
+    result->temperature = regular[1];
+
+    /* VBAT: injected conversion on ADC1, VBAT has priority on channel 18 */
+    ADCCOM->CCR |= CCR_VBATE;
+    ADC1->SR = 0;
+    ADC1->JSQR = JSQR_SINGLE(CHANNEL_TEMP_VBAT);
+    ADC1->CR2 |= ADC_CR2_JSWSTART;
+    while (!(ADC1->SR & ADC_SR_JEOC)) {}
+    result->vbat = (uint16_t)ADC1->JDR1;
+    ADCCOM->CCR &= ~CCR_VBATE;      // reduces the load on the battery
+    ADC1->SR = 0;
+
+    /* POT1 was converted in the meantime */
+    while (!(ADC3->SR & ADC_SR_JEOC)) {}
+    result->pot1 = (uint16_t)ADC3->JDR1;
+    result->pot1_bits = (uint8_t)(12u - 2u * ((ADC3->CR1 >> 24) & 0x3u));
+    ADC3->SR &= ~ADC_SR_JEOC;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static void wait_cycles(uint32_t cycles)
+{
+    uint32_t start = CYCLE_COUNTER;
+
+    while ((CYCLE_COUNTER - start) < cycles) {}
+}
@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_scan.
+ * --
+ * -- Reads POT1 and the internal channels (VREFINT, temperature sensor,
+ * -- VBAT) with one call.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_SCAN_H
+#define _ADC_SCAN_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint16_t pot1;          // ADC3 channel 4, resolution of ADC3->CR1
+    uint8_t pot1_bits;      // valid bits of pot1
+    uint16_t vrefint;       // ADC1 channel 17, 12 bit
+    uint16_t temperature;   // ADC1 channel 18, 12 bit
+    uint16_t vbat;          // ADC1 channel 18 with VBATE, VBAT / 4, 12 bit
+} adc_scan_result_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Enables ADC1 and the internal channels.
+ */
+void adc_scan_init(void);
+
+/*
+ * Converts all channels and fills 'result':
+ * - POT1 with the injected group of ADC3. It is inserted between the
+ *   regular conversions, so it works while adc_dma_start() is active and
+ *   leaves ADC3->CR1 untouched.
+ * - VREFINT and the temperature sensor with one regular scan sequence of
+ *   ADC1, transferred by DMA2 stream 4.
+ * - VBAT with the injected group of ADC1. The temperature sensor and VBAT
+ *   share channel 18 on the STM32F42x, VBAT is only switched to the
+ *   channel for this conversion.
+ * DMA2 stream 4 is shared with adc_capture_burst(), do not call both at
+ * the same time.
+ */
+void adc_scan(adc_scan_result_t *result);
+
+#endif
@@ -0,0 +1,202 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_scope.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_scope.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define RING_MASK           (ADC_SCOPE_RING_SIZE - 1u)
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static uint8_t is_trigger(adc_scope_t *scope, uint16_t value);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_scope_init(adc_scope_t *scope, const adc_scope_config_t *config)
+{
+    scope->state = ADC_SCOPE_DONE;      // the ISR leaves it alone
+    scope->config = *config;
+    if (scope->config.window > ADC_SCOPE_RING_SIZE) {
+        scope->config.window = ADC_SCOPE_RING_SIZE;
+    }
+    if (scope->config.pre_trigger >= scope->config.window) {
+        scope->config.pre_trigger = scope->config.window - 1u;
+    }
+    scope->head = 0;
+    scope->nr_of_triggers = 0;
+    adc_scope_rearm(scope);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_scope_process(adc_scope_t *scope, const uint16_t *block,
+                       uint16_t nr_of_samples)
+{
+    uint16_t head = scope->head;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples; i++) {
+        uint16_t value = block[i];
+
+        if (scope->state == ADC_SCOPE_DONE) {
+            break;
+        }
+        scope->ring[head] = value;
+        head = (head + 1u) & RING_MASK;
+
+        switch (scope->state) {
+            case ADC_SCOPE_HOLDOFF:
+                (void)is_trigger(scope, value);     // track the edge state
+                if (--scope->countdown == 0) {
+                    scope->state = ADC_SCOPE_ARMED;
+                }
+                break;
+            case ADC_SCOPE_ARMED:
+                if (is_trigger(scope, value)) {
+                    /* the trigger sample is the first post-trigger sample */
+                    scope->countdown = scope->config.window
+                                       - scope->config.pre_trigger - 1u;
+                    scope->nr_of_triggers++;
+                    scope->state = (scope->countdown == 0) ?
+                                   ADC_SCOPE_DONE : ADC_SCOPE_TRIGGERED;
+                }
+                break;
+            case ADC_SCOPE_TRIGGERED:
+                if (--scope->countdown == 0) {
+                    scope->state = ADC_SCOPE_DONE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    scope->head = head;
+}
+
+
+/*
+ *  See header file
+ */
+uint8_t adc_scope_done(const adc_scope_t *scope)
+{
+    return (scope->state == ADC_SCOPE_DONE) ? 1 : 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint16_t adc_scope_decimate(const adc_scope_t *scope, uint16_t *minimum,
+                            uint16_t *maximum, uint16_t nr_of_columns)
+{
+    uint16_t window = scope->config.window;
+    uint16_t start = (scope->head - window) & RING_MASK;
+    uint16_t column;
+    uint16_t first;
+    uint16_t end;
+    uint16_t i;
+
+    for (column = 0; column < nr_of_columns; column++) {
+        uint16_t low = 0xFFFF;
+        uint16_t high = 0;
+
+        first = (uint16_t)(((uint32_t)column * window) / nr_of_columns);
+        end = (uint16_t)(((uint32_t)(column + 1u) * window) / nr_of_columns);
+        if (end <= first) {
+            end = first + 1u;       // window shorter than the columns
+        }
+        for (i = first; i < end; i++) {
+            uint16_t value = scope->ring[(start + i) & RING_MASK];
+
+            if (value < low) {
+                low = value;
+            }
+            if (value > high) {
+                high = value;
+            }
+        }
+        minimum[column] = low;
+        maximum[column] = high;
+    }
+    return (uint16_t)(((uint32_t)scope->config.pre_trigger * nr_of_columns)
+                      / window);
+}
+
+
+/*
+ *  See header file
+ */
+void adc_scope_rearm(adc_scope_t *scope)
+{
+    scope->countdown = scope->config.holdoff;
+    if (scope->countdown < scope->config.pre_trigger) {
+        scope->countdown = scope->config.pre_trigger;
+    }
+    scope->edge_armed = 0;
+    scope->state = (scope->countdown == 0) ? ADC_SCOPE_ARMED
+                                           : ADC_SCOPE_HOLDOFF;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Level: the sample is beyond the level in the direction of the slope.
+ * Edge: the same, but only after the signal was on the other side of the
+ * level by more than the hysteresis, so noise around the level does not
+ * trigger repeatedly.
+ */
+static uint8_t is_trigger(adc_scope_t *scope, uint16_t value)
+{
+    const adc_scope_config_t *config = &scope->config;
+    uint8_t beyond;
+    uint8_t before;
+
+    if (config->slope == ADC_SCOPE_RISING) {
+        beyond = (value >= config->level);
+        before = (value + config->hysteresis < config->level);
+    } else {
+        beyond = (value <= config->level);
+        before = (value > config->level + config->hysteresis);
+    }
+
+    if (config->mode == ADC_SCOPE_LEVEL) {
+        return beyond;
+    }
+    if (before) {
+        scope->edge_armed = 1;
+    } else if (beyond && scope->edge_armed) {
+        scope->edge_armed = 0;
+        return 1;
+    }
+    return 0;
+}
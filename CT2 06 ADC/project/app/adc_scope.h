@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_scope.
+ * --
+ * -- Trigger engine on the sample stream of the continuous acquisition:
+ * -- level or edge trigger, holdoff and pre-trigger ring buffer.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_SCOPE_H
+#define _ADC_SCOPE_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* Ring buffer, power of two. Upper limit of the capture window. */
+#define ADC_SCOPE_RING_LOG2     10u
+#define ADC_SCOPE_RING_SIZE     (1u << ADC_SCOPE_RING_LOG2)
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef enum {
+    ADC_SCOPE_EDGE = 0,         // crossing of the level, re-armed by hysteresis
+    ADC_SCOPE_LEVEL = 1         // any sample beyond the level
+} adc_scope_mode_t;
+
+typedef enum {
+    ADC_SCOPE_RISING = 0,
+    ADC_SCOPE_FALLING = 1
+} adc_scope_slope_t;
+
+typedef enum {
+    ADC_SCOPE_HOLDOFF = 0,      // filling the pre-trigger, trigger ignored
+    ADC_SCOPE_ARMED = 1,        // waiting for the trigger
+    ADC_SCOPE_TRIGGERED = 2,    // acquiring the post-trigger part
+    ADC_SCOPE_DONE = 3          // window frozen until adc_scope_rearm()
+} adc_scope_state_t;
+
+typedef struct {
+    adc_scope_mode_t mode;
+    adc_scope_slope_t slope;
+    uint16_t level;             // same scale as the samples
+    uint16_t hysteresis;        // edge mode: distance to re-arm
+    uint16_t window;            // samples per capture, <= ADC_SCOPE_RING_SIZE
+    uint16_t pre_trigger;       // samples before the trigger, < window
+    uint32_t holdoff;           // samples ignored after re-arm
+} adc_scope_config_t;
+
+typedef struct {
+    adc_scope_config_t config;
+    volatile adc_scope_state_t state;
+    uint16_t ring[ADC_SCOPE_RING_SIZE];
+    uint16_t head;              // next write position
+    uint32_t countdown;         // holdoff or post-trigger samples left
+    uint8_t edge_armed;         // edge mode: signal was beyond hysteresis
+    uint32_t nr_of_triggers;
+} adc_scope_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Applies 'config' and arms the trigger after the holdoff. The holdoff is
+ * at least the pre-trigger length, so the ring always holds it.
+ */
+void adc_scope_init(adc_scope_t *scope, const adc_scope_config_t *config);
+
+/*
+ * Feeds a block of samples, to be called from the block callback of
+ * adc_dma_start(). A few compares per sample, so it keeps up with the
+ * full rate. Samples are discarded while the scope is DONE.
+ */
+void adc_scope_process(adc_scope_t *scope, const uint16_t *block,
+                       uint16_t nr_of_samples);
+
+/*
+ * Returns 1 if a window was captured and can be read.
+ */
+uint8_t adc_scope_done(const adc_scope_t *scope);
+
+/*
+ * Decimates the captured window into 'nr_of_columns' columns and returns
+ * the minimum and maximum of each, so that short spikes stay visible.
+ * Returns the column of the trigger. Only valid while adc_scope_done().
+ */
+uint16_t adc_scope_decimate(const adc_scope_t *scope, uint16_t *minimum,
+                            uint16_t *maximum, uint16_t nr_of_columns);
+
+/*
+ * Releases the captured window and starts the next holdoff.
+ */
+void adc_scope_rearm(adc_scope_t *scope);
+
+#endif
@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module adc_stats.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "adc_stats.h"
+
+/* SIMD only with the target set to Cortex-M4, see adc_stats.h */
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#define STATS_SIMD32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define STATS_SSE2
+#endif
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void accumulate(const uint16_t *samples, uint16_t nr_of_samples,
+                       uint16_t *minimum, uint16_t *maximum,
+                       uint32_t *sum, uint64_t *sum_of_squares);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void adc_stats_block(const uint16_t *samples, uint16_t nr_of_samples,
+                     adc_stats_t *stats)
+{
+    uint16_t minimum;
+    uint16_t maximum;
+    uint32_t sum;
+    uint64_t sum_of_squares;
+    uint64_t mean_square;
+
+    accumulate(samples, nr_of_samples, &minimum, &maximum, &sum,
+               &sum_of_squares);
+
+    stats->minimum = minimum;
+    stats->maximum = maximum;
+    stats->peak_to_peak = maximum - minimum;
+    stats->mean = (uint16_t)((sum + nr_of_samples / 2u) / nr_of_samples);
+    stats->rms = (uint16_t)adc_stats_isqrt(sum_of_squares / nr_of_samples);
+
+    /* n^2 * variance = n * sum(x^2) - sum(x)^2 */
+    mean_square = (uint64_t)nr_of_samples * sum_of_squares
+                  - (uint64_t)sum * sum;
+    stats->ac_rms = (uint16_t)(adc_stats_isqrt(mean_square) / nr_of_samples);
+}
+
+
+/*
+ *  See header file
+ */
+uint32_t adc_stats_isqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+#if defined(STATS_SIMD32)
+
+/*
+ * Two samples per word. USUB16 sets the GE flags per half word, SEL then
+ * picks the smaller and the larger half words. SMLAD and SMLALD add both
+ * products, the squares go into 64 bit since 4096 * 4095^2 > 2^32.
+ */
+static void accumulate(const uint16_t *samples, uint16_t nr_of_samples,
+                       uint16_t *minimum, uint16_t *maximum,
+                       uint32_t *sum, uint64_t *sum_of_squares)
+{
+    const uint32_t *pairs = (const uint32_t *)samples;
+    uint16x2_t low = 0xFFFFFFFFu;
+    uint16x2_t high = 0;
+    int32_t total = 0;
+    uint64_t squares = 0;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples / 2u; i++) {
+        uint16x2_t x = pairs[i];
+
+        (void)__usub16(x, low);
+        low = __sel(low, x);
+        (void)__usub16(x, high);
+        high = __sel(x, high);
+        total = __smlad((int16x2_t)x, 0x00010001, total);
+        squares = (uint64_t)__smlald((int16x2_t)x, (int16x2_t)x,
+                                     (int64_t)squares);
+    }
+
+    *minimum = ((low & 0xFFFF) < (low >> 16)) ? (uint16_t)low
+                                               : (uint16_t)(low >> 16);
+    *maximum = ((high & 0xFFFF) > (high >> 16)) ? (uint16_t)high
+                                                 : (uint16_t)(high >> 16);
+    *sum = (uint32_t)total;
+    *sum_of_squares = squares;
+}
+
+#elif defined(STATS_SSE2)
+
+/*
+ * Eight samples per step. Samples of up to 12 bit are positive as signed
+ * 16 bit, so the signed min/max and PMADDWD can be used. PMADDWD adds
+ * two squares into 32 bit, which are widened to 64 bit per step.
+ */
+static void accumulate(const uint16_t *samples, uint16_t nr_of_samples,
+                       uint16_t *minimum, uint16_t *maximum,
+                       uint32_t *sum, uint64_t *sum_of_squares)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = _mm_set1_epi16(0x7FFF);
+    __m128i high = zero;
+    __m128i total = zero;
+    __m128i squares = zero;
+    int16_t lanes[8];
+    uint64_t wide[2];
+    int32_t parts[4];
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples; i += 8u) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&samples[i]);
+        __m128i x2 = _mm_madd_epi16(x, x);
+
+        low = _mm_min_epi16(low, x);
+        high = _mm_max_epi16(high, x);
+        total = _mm_add_epi32(total, _mm_madd_epi16(x, ones));
+        squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(x2, zero));
+        squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(x2, zero));
+    }
+
+    _mm_storeu_si128((__m128i *)lanes, low);
+    *minimum = (uint16_t)lanes[0];
+    for (i = 1; i < 8u; i++) {
+        if ((uint16_t)lanes[i] < *minimum) {
+            *minimum = (uint16_t)lanes[i];
+        }
+    }
+    _mm_storeu_si128((__m128i *)lanes, high);
+    *maximum = (uint16_t)lanes[0];
+    for (i = 1; i < 8u; i++) {
+        if ((uint16_t)lanes[i] > *maximum) {
+            *maximum = (uint16_t)lanes[i];
+        }
+    }
+    _mm_storeu_si128((__m128i *)parts, total);
+    *sum = (uint32_t)(parts[0] + parts[1] + parts[2] + parts[3]);
+    _mm_storeu_si128((__m128i *)wide, squares);
+    *sum_of_squares = wide[0] + wide[1];
+}
+
+#else
+
+static void accumulate(const uint16_t *samples, uint16_t nr_of_samples,
+                       uint16_t *minimum, uint16_t *maximum,
+                       uint32_t *sum, uint64_t *sum_of_squares)
+{
+    uint16_t low = 0xFFFF;
+    uint16_t high = 0;
+    uint32_t total = 0;
+    uint64_t squares = 0;
+    uint16_t i;
+
+    for (i = 0; i < nr_of_samples; i++) {
+        uint16_t x = samples[i];
+
+        if (x < low) {
+            low = x;
+        }
+        if (x > high) {
+            high = x;
+        }
+        total += x;
+        squares += (uint32_t)x * x;
+    }
+
+    *minimum = low;
+    *maximum = high;
+    *sum = total;
+    *sum_of_squares = squares;
+}
+
+#endif
@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module adc_stats.
+ * --
+ * -- Statistics of a block of samples in one pass. Two samples per step
+ * -- with the dual 16 bit SIMD instructions of the Cortex-M4, eight with
+ * -- SSE2 on a host, one in portable C elsewhere.
+ * -- Note: the Keil build uses the portable loop, ADC.uvprojx targets a
+ * -- Cortex-M0 (see adc_fft.h).
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _ADC_STATS_H
+#define _ADC_STATS_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define ADC_STATS_MIN_LOG2      5u          // 32 samples
+#define ADC_STATS_MAX_LOG2      12u         // 4096 samples
+#define ADC_STATS_MAX_SIZE      (1u << ADC_STATS_MAX_LOG2)
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+/* All values in LSB of the samples */
+typedef struct {
+    uint16_t minimum;
+    uint16_t maximum;
+    uint16_t peak_to_peak;
+    uint16_t mean;
+    uint16_t rms;               // sqrt(mean(x^2)), including the mean
+    uint16_t ac_rms;            // sqrt(mean(x^2) - mean^2), standard deviation
+} adc_stats_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Computes the statistics of 'nr_of_samples' samples of up to 12 bit in
+ * one pass. nr_of_samples must be a multiple of 8, up to
+ * ADC_STATS_MAX_SIZE. 'samples' must be 4 byte aligned.
+ */
+void adc_stats_block(const uint16_t *samples, uint16_t nr_of_samples,
+                     adc_stats_t *stats);
+
+/*
+ * Integer square root, rounded down
+ */
+uint32_t adc_stats_isqrt(uint64_t value);
+
+#endif
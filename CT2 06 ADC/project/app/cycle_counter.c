@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module cycle_counter.
+ * --
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+
+/* user includes */
+#include "cycle_counter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define DEMCR          (*((volatile uint32_t *)(0xE000EDFC)))
+#define DWT_CTRL       (*((volatile uint32_t *)(0xE0001000)))
+
+#define DEMCR_TRCENA   (0x1 << 24)     // enable DWT and ITM
+#define DWT_CYCCNTENA  (0x1 << 0)      // enable cycle counter
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void cycle_counter_init(void)
+{
+    DEMCR |= DEMCR_TRCENA;
+    CYCLE_COUNTER = 0;
+    DWT_CTRL |= DWT_CYCCNTENA;
+}
@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module cycle_counter.
+ * --
+ * -- Access to the DWT cycle counter of the Cortex-M4 for measuring the
+ * -- execution time of code sections in CPU clock cycles.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _CYCLE_COUNTER_H
+#define _CYCLE_COUNTER_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+/* Free running 32 bit counter, incremented every CPU clock cycle */
+#define CYCLE_COUNTER  (*((volatile uint32_t *)(0xE0001004)))
+
+/* CPU clock (HCLK) set up by system_ctboard.c */
+#define CPU_CLOCK_HZ   84000000u
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Enables the DWT unit and starts the cycle counter.
+ */
+void cycle_counter_init(void);
+
+#endif
@@ -22,10 +22,25 @@
 
 /* standard includes */
 #include <stdint.h>
+#include <stdio.h>
 
 /* user includes */
 #include "reg_ctboard.h"
 #include "adc.h"
+#include "adc_auto.h"
+#include "adc_bench.h"
+#include "adc_calib.h"
+#include "adc_capture.h"
+#include "adc_fft.h"
+#include "adc_filter.h"
+#include "adc_freq.h"
+#include "adc_goertzel.h"
+#include "adc_log.h"
+#include "adc_median.h"
+#include "adc_scan.h"
+#include "adc_scope.h"
+#include "adc_stats.h"
+#include "cycle_counter.h"
 #include "hal_ct_lcd.h"
 
 
@@ -51,17 +66,133 @@
 
 /// STUDENTS: To be programmed
 
+#define FILTER_SELECT_MASK  0x07    // S2..S0 -> adc_filter_type_t
+#define DMA_MODE_MASK       0x80    // S7 -> continuous acquisition
+#define OVERSAMPLE_MASK     0x40    // S6 -> fixed rate, oversampled
+#define EXTRA_BITS_MASK     0x30    // S5..S4 -> 1..4 additional bits
+#define EXTRA_BITS_SHIFT    4
+#define ACQUISITION_CODE_MASK 0x0F  // mode codes below, clear of S7..S4
+#define SAMPLE_RATE_HZ      102400u // 4^4 samples -> 400 Hz at 16 bit
+#define LCD_LINE_2          20
+#define LCD_LINE_LENGTH     20
+#define BURST_BUTTON_MASK   0x01    // T0 -> burst into external SRAM
+#define BENCH_MODE_MASK     0x08    // S3 -> resolution/sample time sweep
+#define BENCH_STEP_MASK     0x02    // T1 -> next sample time in the table
+#define NOISE_BUDGET_UV     1000u   // marks the fastest entry below 1 mV
+#define SCAN_BUTTON_MASK    0x04    // T2 -> POT1 and internal channels
+#define CALIB_BUTTON_MASK   0x08    // T3 -> reciprocal against division
+#define AUTO_MODE_MASK      0x04    // HEXSW 4..7 -> adaptive resolution
+#define AUTO_TARGET_UV      2000u   // precision held by the auto mode
+#define SCOPE_MODE_MASK     0x08    // HEXSW 8..15 -> triggered capture
+#define SCOPE_ACQUISITION   0x01    // acquisition value of the scope mode
+#define SCOPE_FALLING_MASK  0x01    // S16 -> falling slope
+#define SCOPE_LEVEL_MASK    0x02    // S17 -> level instead of edge trigger
+#define SCOPE_WINDOW        640u    // 32 columns of 20 samples
+#define SCOPE_PRE_TRIGGER   160u    // first quarter of the window
+#define SCOPE_HOLDOFF       4096u
+#define NR_OF_LEDS          32u
+#define SPECTRUM_MODE_MASK  0x04    // S18 -> FFT of POT1
+#define SPECTRUM_ACQUISITION 0x02   // acquisition value of the FFT mode
+#define FFT_SIZE_MASK       0x38    // S21..S19 -> 64 .. 1024 points
+#define FFT_SIZE_SHIFT      3
+#define FFT_SAMPLE_RATE_HZ  10240u  // 10 Hz per bin at 1024 points
+#define FFT_BENCH_MASK      0x02    // T1 -> time all FFT sizes
+#define STATS_MODE_MASK     0x40    // S22 -> block statistics
+#define STATS_ACQUISITION   0x03    // acquisition value of the stats mode
+#define LOG_MODE_MASK       0x80    // S23 -> log into the external SRAM
+#define LOG_ACQUISITION     0x04    // acquisition value of the log mode
+#define LOG_SAMPLE_RATE_HZ  10240u
+#define ASYNC_MODE_MASK     0x01    // S24 -> conversion overlaps the display
+#define MEDIAN_LENGTH_MASK  0x1E    // S28..S25 -> median of 2^(n+1) - 1
+#define MEDIAN_LENGTH_SHIFT 1
+#define MEDIAN_MAX_N        9u      // 1023 samples
+#define TONE_MODE_MASK      0x20    // S29 -> DTMF tone detectors
+#define TONE_ACQUISITION    0x05    // acquisition value of the tone mode
+#define TONE_SAMPLE_RATE_HZ 8000u
+#define TONE_BLOCK_LENGTH   205u    // 39 Hz resolution, 25.6 ms per block
+#define TONE_THRESHOLD      100u    // amplitude in 12 bit LSB, about 80 mV
+#define TONE_MIN_SHARE      20u     // % of the AC power, rejects noise
+#define TONE_NR_OF_ROWS     4u      // detectors 0..3 rows, 4..7 columns
+#define FREQ_MODE_MASK      0x40    // S30 -> frequency and period meter
+#define FREQ_ACQUISITION    0x06    // acquisition value of the meter
+#define FREQ_SAMPLE_RATE_HZ 100000u
+#define FREQ_PERIODS_MASK   0x38    // S21..S19 -> 1 .. 128 periods
+#define FREQ_PERIODS_SHIFT  3
+#define FREQ_HYSTERESIS     16u     // 12 bit LSB, about 13 mV
+#define AVG_BENCH_MASK      0x02    // T1 -> time adc_avg, 1 .. 1024 samples
 
+/// END: To be programmed
 
 
-/// END: To be programmed
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static adc_filter_t filter;
+static adc_oversample_t oversample;
+static adc_bench_table_t bench;
+static adc_auto_t controller;
+static adc_calib_t calib;
+static adc_scope_t scope;
+static volatile uint8_t scoping = 0;
+static volatile uint8_t spectrum = 0;
+static uint16_t fft_samples[ADC_FFT_MAX_SIZE];
+static int32_t fft_buffer[ADC_FFT_MAX_SIZE];
+static volatile uint16_t fft_fill = 0;      // samples in fft_samples
+static volatile uint16_t fft_size = ADC_FFT_MAX_SIZE;
+static volatile uint8_t statistics = 0;
+static volatile uint8_t logging = 0;
+static adc_log_t sample_log;
+static uint32_t stats_words[ADC_STATS_MAX_SIZE / 2u];  // word aligned
+static uint16_t *const stats_samples = (uint16_t *)stats_words;
+static volatile uint16_t stats_fill = 0;
+static volatile uint16_t stats_size = ADC_STATS_MAX_SIZE;
+static volatile uint8_t oversampling = 0;
+static volatile uint16_t block_value = 0;
+static adc_async_t conversion;
+static volatile uint8_t tones = 0;
+static adc_goertzel_t tone_bank;
+static volatile uint8_t metering = 0;
+static adc_freq_t meter;
+
+// DTMF: 4 row and 4 column frequencies, a key sends one of each
+static const uint16_t tone_frequency[ADC_GOERTZEL_MAX_DETECTORS] = {
+    697, 770, 852, 941, 1209, 1336, 1477, 1633
+};
+static const char tone_key[] = "123A456B789C*0#D";
 
 
 /* -- Local function declaration
  * ------------------------------------------------------------------------- */
-static uint16_t normalize_value(uint16_t value, adc_resolution_t resolution);
 static void display_on_lcd(uint16_t bcd_value);
 static void convert_hex_to_ascii(uint16_t hex_value, char* characters);
+static void display_cycles_on_lcd(uint32_t cycles);
+static void display_rate_on_lcd(uint32_t samples_per_s, uint32_t load_permille);
+static void display_overlap_on_lcd(uint32_t sync_rate, uint32_t async_rate);
+static uint16_t read_median_length(void);
+static void display_median_on_lcd(const adc_median_report_t *report);
+static void display_burst_on_lcd(const adc_capture_result_t *result);
+static void display_auto_on_lcd(uint32_t samples_per_s);
+static void display_scan_on_lcd(const adc_scan_result_t *result);
+static void display_calib_on_lcd(uint8_t bits);
+static void display_bench_on_lcd(const adc_bench_entry_t *entry,
+                                 uint8_t is_fastest);
+static void process_block(const uint16_t *block, uint16_t nr_of_samples);
+static void read_scope_config(adc_scope_config_t *config, uint8_t bits);
+static uint32_t display_scope(uint8_t bits);
+static uint8_t read_fft_log2(void);
+static void display_spectrum(uint8_t log2, uint8_t bits);
+static void display_fft_benchmark(void);
+static void display_avg_benchmark(void);
+static uint16_t read_stats_size(void);
+static void display_stats(uint16_t nr_of_samples, uint8_t bits);
+static void display_log(void);
+static void init_tones(uint8_t bits);
+static void display_tone_event(const adc_goertzel_event_t *event);
+static void display_tone_load(void);
+static uint16_t read_freq_periods(void);
+static void init_meter(uint16_t nr_of_periods, uint8_t bits);
+static void display_frequency(const adc_freq_result_t *result, uint8_t bits);
+static unsigned saturate(uint32_t value, uint32_t max);
 
 
 /* -- M A I N
@@ -71,15 +202,76 @@ int main(void)
 {
     /// STUDENTS: To be programmed
 		adc_init();
+		adc_capture_init();
+		adc_scan_init();
+		cycle_counter_init();
+		adc_fft_init();
 		adc_resolution_t resolution;
+		adc_resolution_t previous_resolution = ADC_RES_12BIT;
+		uint8_t filter_select;
+		uint8_t previous_filter_select = 0xFF;
+		uint8_t acquisition;
+		uint8_t previous_acquisition = 0xFF;
+		uint16_t filtered = 0;
+		uint32_t start;
+		uint32_t cycles;
+		uint32_t rate_start = 0;
+		uint32_t rate_samples = 0;
+		uint32_t rate_busy = 0;
+		uint32_t samples;
+		uint32_t busy;
+		uint8_t burst_button;
+		adc_capture_result_t burst;
+		uint8_t bench_valid = 0;
+		uint8_t bench_fastest = ADC_BENCH_NONE;
+		uint8_t bench_index;
+		uint8_t bench_sample_time = 0;
+		uint8_t step_button;
+		uint8_t previous_step_button = 0;
+		adc_scan_result_t scan;
+		uint8_t scanning = 0;
+		adc_scope_config_t scope_config;
+		uint32_t scope_leds = 0;
+		uint8_t fft_log2 = ADC_FFT_MAX_LOG2;
+		uint8_t calib_button;
+		uint8_t previous_calib_button = 0;
+		uint8_t auto_mode;
+		uint8_t previous_auto_mode = 0;
+		uint8_t async_mode = 0;
+		uint8_t previous_async_mode = 0;
+		uint8_t async_pending = 0;
+		uint8_t async_ready;
+		uint16_t async_value = 0;
+		uint32_t loop_count = 0;
+		uint32_t loop_start = 0;
+		uint32_t sync_rate = 0;
+		uint32_t async_rate = 0;
+		uint16_t median_length;
+		uint16_t previous_median_length = 0;
+		adc_median_report_t median_report;
+		adc_goertzel_event_t tone_event;
+		uint16_t freq_periods;
+		uint16_t previous_freq_periods = 0;
+		adc_freq_result_t frequency;
+	
+		// VDDA aus VREFINT, danach nur noch Multiplikation pro Sample
+		adc_scan(&scan);
+		adc_calib_update(&calib, scan.vrefint);
 	
 		while(1){
 			
 			uint16_t value;
 			resolution = ADC_RES_6BIT;
 			
+			// laufende Wandlung abholen, bevor ein anderer Modus den ADC
+			// umkonfiguriert
+			async_ready = async_pending;
+			if (async_pending){
+				async_value = adc_wait_async(&conversion);
+				async_pending = 0;
+			}
+			
 			
-			uint16_t s;
 			uint8_t hex = CT_HEXSW & 0x3;
 			//CT_LED->BYTE.LED23_16 = hex;
 			switch(hex){
@@ -103,21 +295,383 @@ int main(void)
 					break;
 			}
 			
-			value = adc_get_value(resolution);
-						
+			// HEXSW 4..7: Aufloesung und Abtastzeit automatisch
+			auto_mode = CT_HEXSW & AUTO_MODE_MASK;
+			if (auto_mode && !previous_auto_mode){
+				adc_auto_init(&controller, AUTO_TARGET_UV);
+				adc_set_sample_time(controller.sample_time);
+				rate_samples = 0;
+				rate_start = CYCLE_COUNTER;
+			} else if (!auto_mode && previous_auto_mode){
+				adc_set_sample_time(ADC_SMP_3CYC);
+			}
+			previous_auto_mode = auto_mode;
+			if (auto_mode){
+				resolution = controller.resolution;
+				CT_LED->HWORD.LED15_0 = (uint16_t)((1u << controller.bits) - 1u);
+			}
+			
+			// S3: Messung aller Aufloesungen und Abtastzeiten, HEXSW
+			// waehlt die Aufloesung und T1 blaettert durch die Abtastzeiten
+			if (CT_DIPSW->BYTE.S7_0 & BENCH_MODE_MASK){
+				if (!bench_valid){
+					adc_dma_stop();
+					hal_ct_lcd_clear();
+					adc_bench_run(&bench);
+					bench_fastest = adc_bench_fastest(&bench,
+					                                  NOISE_BUDGET_UV);
+					bench_valid = 1;
+				}
+				step_button = CT_BUTTON & BENCH_STEP_MASK;
+				if (step_button && !previous_step_button){
+					bench_sample_time = (bench_sample_time + 1u)
+					                    % ADC_BENCH_NR_OF_SAMPLE_TIMES;
+				}
+				previous_step_button = step_button;
+				
+				// table row 0 = 12 bit, HEXSW 0 = 6 bit
+				bench_index = (uint8_t)((ADC_BENCH_NR_OF_RESOLUTIONS - 1u - hex)
+				              * ADC_BENCH_NR_OF_SAMPLE_TIMES + bench_sample_time);
+				display_bench_on_lcd(
+				    &bench.entry[0][0] + bench_index,
+				    bench_index == bench_fastest);
+				continue;
+			}
+			if (bench_valid){
+				// restart the selected acquisition mode
+				bench_valid = 0;
+				hal_ct_lcd_clear();
+				previous_filter_select = 0xFF;
+			}
+			
+			// S2..S0 waehlen den Filter, S0 allein = Boxcar wie bisher
+			// S7 waehlt kontinuierliche Erfassung mit DMA
+			// S6 waehlt feste Abtastrate mit Oversampling (ohne Filter)
+			filter_select = CT_DIPSW->BYTE.S7_0 & FILTER_SELECT_MASK;
+			// S2..S0 = 5: Median, Fensterlaenge mit S28..S25
+			median_length = read_median_length();
+			acquisition = CT_DIPSW->BYTE.S7_0
+			              & (DMA_MODE_MASK | OVERSAMPLE_MASK | EXTRA_BITS_MASK);
+			// HEXSW 8..15: Oszilloskop, Triggerpegel mit S15..S8
+			if (CT_HEXSW & SCOPE_MODE_MASK){
+				acquisition = DMA_MODE_MASK | SCOPE_ACQUISITION;
+			} else if (CT_DIPSW->BYTE.S23_16 & SPECTRUM_MODE_MASK){
+				// S18: Spektrum mit fester Abtastrate
+				acquisition = SPECTRUM_ACQUISITION;
+			} else if (CT_DIPSW->BYTE.S23_16 & STATS_MODE_MASK){
+				// S22: Statistik ueber Bloecke von 32 bis 4096 Samples
+				acquisition = DMA_MODE_MASK | STATS_ACQUISITION;
+			} else if (CT_DIPSW->BYTE.S23_16 & LOG_MODE_MASK){
+				// S23: komprimiertes Logging ins externe SRAM
+				acquisition = LOG_ACQUISITION;
+			} else if (CT_DIPSW->BYTE.S31_24 & TONE_MODE_MASK){
+				// S29: Goertzel-Detektoren fuer die DTMF-Toene
+				acquisition = TONE_ACQUISITION;
+			} else if (CT_DIPSW->BYTE.S31_24 & FREQ_MODE_MASK){
+				// S30: Frequenz ueber 1 bis 128 Perioden, Anzahl mit S21..S19
+				acquisition = FREQ_ACQUISITION;
+			}
+			freq_periods = read_freq_periods();
+			if (acquisition & OVERSAMPLE_MASK){
+				resolution = ADC_RES_12BIT;
+			}
+			
+			// T0: Burst mit allen drei ADCs ins externe SRAM,
+			// Resultat bleibt angezeigt solange T0 gedrueckt ist
+			burst_button = CT_BUTTON & BURST_BUTTON_MASK;
+			if (burst_button){
+				adc_dma_stop();
+				burst = adc_capture_burst(ADC_CAPTURE_MAX_SAMPLES);
+				display_burst_on_lcd(&burst);
+				while (CT_BUTTON & BURST_BUTTON_MASK){}
+				// restart the selected acquisition mode
+				previous_filter_select = 0xFF;
+			}
+			
+			// T2: POT1, VREFINT, Temperatur und VBAT in einem Aufruf,
+			// laeuft auch waehrend der kontinuierlichen Erfassung
+			if (CT_BUTTON & SCAN_BUTTON_MASK){
+				adc_scan(&scan);
+				adc_calib_update(&calib, scan.vrefint);
+				display_scan_on_lcd(&scan);
+				scanning = 1;
+				continue;
+			}
+			// T3: Kalibrierung pruefen, Resultat bleibt bis T3 losgelassen
+			calib_button = CT_BUTTON & CALIB_BUTTON_MASK;
+			if (calib_button){
+				if (!previous_calib_button){
+					display_calib_on_lcd(adc_calib_bits(resolution));
+				}
+				previous_calib_button = calib_button;
+				scanning = 1;
+				continue;
+			}
+			previous_calib_button = calib_button;
+			if (scanning){
+				hal_ct_lcd_clear();
+				scanning = 0;
+			}
+			
+			if (filter_select != previous_filter_select
+			        || acquisition != previous_acquisition
+			        || resolution != previous_resolution
+			        || (filter_select == ADC_FILTER_MEDIAN
+			            && median_length != previous_median_length)
+			        || ((acquisition & ACQUISITION_CODE_MASK)
+			                == FREQ_ACQUISITION
+			            && freq_periods != previous_freq_periods)){
+				// the DMA interrupt must not run the filter meanwhile
+				adc_dma_stop();
+				adc_filter_init(&filter, (adc_filter_type_t)filter_select);
+				if (filter.type == ADC_FILTER_MEDIAN){
+					// Heap gegen Sortieren, Resultat bleibt auf Zeile 2
+					adc_median_init(&filter.state.median, median_length);
+					adc_median_benchmark(median_length, &median_report);
+					display_median_on_lcd(&median_report);
+				}
+				previous_median_length = median_length;
+				previous_freq_periods = freq_periods;
+				adc_oversample_init(&oversample, 1 +
+				    ((acquisition & EXTRA_BITS_MASK) >> EXTRA_BITS_SHIFT));
+				oversampling = acquisition & OVERSAMPLE_MASK;
+				scoping = (acquisition & ACQUISITION_CODE_MASK)
+				          == SCOPE_ACQUISITION;
+				if (scoping){
+					read_scope_config(&scope_config,
+					                  adc_calib_bits(resolution));
+					adc_scope_init(&scope, &scope_config);
+					hal_ct_lcd_clear();
+				}
+				spectrum = (acquisition & ACQUISITION_CODE_MASK)
+				           == SPECTRUM_ACQUISITION;
+				statistics = (acquisition & ACQUISITION_CODE_MASK)
+				             == STATS_ACQUISITION;
+				logging = (acquisition & ACQUISITION_CODE_MASK)
+				          == LOG_ACQUISITION;
+				tones = (acquisition & ACQUISITION_CODE_MASK)
+				        == TONE_ACQUISITION;
+				metering = (acquisition & ACQUISITION_CODE_MASK)
+				           == FREQ_ACQUISITION;
+				if (statistics){
+					stats_size = read_stats_size();
+					stats_fill = 0;
+					hal_ct_lcd_clear();
+				}
+				if (logging){
+					adc_log_init(&sample_log);
+					hal_ct_lcd_clear();
+					adc_dma_start(resolution, LOG_SAMPLE_RATE_HZ,
+					              process_block);
+					rate_start = CYCLE_COUNTER;
+				} else if (tones){
+					init_tones(adc_calib_bits(resolution));
+					hal_ct_lcd_clear();
+					adc_dma_start(resolution, TONE_SAMPLE_RATE_HZ,
+					              process_block);
+					rate_start = CYCLE_COUNTER;
+				} else if (metering){
+					init_meter(freq_periods, adc_calib_bits(resolution));
+					hal_ct_lcd_clear();
+					adc_dma_start(resolution, FREQ_SAMPLE_RATE_HZ,
+					              process_block);
+				} else if (spectrum){
+					fft_log2 = read_fft_log2();
+					fft_size = (uint16_t)(1u << fft_log2);
+					fft_fill = 0;
+					hal_ct_lcd_clear();
+					adc_dma_start(resolution, FFT_SAMPLE_RATE_HZ,
+					              process_block);
+				} else if (oversampling){
+					adc_dma_start(resolution, SAMPLE_RATE_HZ, process_block);
+					adc_dma_statistics(&rate_samples, &rate_busy);
+					rate_start = CYCLE_COUNTER;
+				} else if (acquisition & DMA_MODE_MASK){
+					adc_dma_start(resolution, ADC_RATE_CONTINUOUS,
+					              process_block);
+					adc_dma_statistics(&rate_samples, &rate_busy);
+					rate_start = CYCLE_COUNTER;
+				}
+				previous_filter_select = filter_select;
+				previous_acquisition = acquisition;
+				previous_resolution = resolution;
+			}
+			
+			if (spectrum){
+				// T1: alle FFT-Groessen von 64 bis 1024 Punkten messen,
+				// Resultat bleibt angezeigt solange T1 gedrueckt ist
+				if (CT_BUTTON & FFT_BENCH_MASK){
+					adc_dma_stop();
+					display_fft_benchmark();
+					while (CT_BUTTON & FFT_BENCH_MASK){}
+					// restart the selected acquisition mode
+					previous_filter_select = 0xFF;
+					continue;
+				}
+				// the ISR stops filling when the buffer is full
+				if (fft_fill >= fft_size){
+					display_spectrum(fft_log2, adc_calib_bits(resolution));
+					fft_log2 = read_fft_log2();
+					fft_size = (uint16_t)(1u << fft_log2);
+					fft_fill = 0;
+				}
+				continue;
+			}
+			
+			if (logging){
+				if (CYCLE_COUNTER - rate_start >= CPU_CLOCK_HZ){
+					display_log();
+					rate_start += CPU_CLOCK_HZ;
+				}
+				continue;
+			}
+			
+			if (tones){
+				// Ereignisse aus dem DMA-Interrupt, LED23..16 = Toene
+				while (adc_goertzel_get_event(&tone_bank, &tone_event)){
+					display_tone_event(&tone_event);
+				}
+				CT_LED->BYTE.LED23_16 = tone_bank.present;
+				if (CYCLE_COUNTER - rate_start >= CPU_CLOCK_HZ){
+					display_tone_load();
+					rate_start += CPU_CLOCK_HZ;
+				}
+				continue;
+			}
+			
+			if (metering){
+				if (adc_freq_read(&meter, &frequency)){
+					display_frequency(&frequency, adc_calib_bits(resolution));
+				}
+				continue;
+			}
+			
+			if (statistics){
+				if (stats_fill >= stats_size){
+					display_stats(stats_size, adc_calib_bits(resolution));
+					stats_size = read_stats_size();
+					stats_fill = 0;
+				}
+				continue;
+			}
+			
+			if (scoping){
+				// the ISR leaves a captured window alone
+				if (adc_scope_done(&scope)){
+					scope_leds = display_scope(adc_calib_bits(resolution));
+					read_scope_config(&scope.config,
+					                  adc_calib_bits(resolution));
+					adc_scope_rearm(&scope);
+				}
+				CT_LED->WORD = scope_leds;
+				continue;
+			}
+			
+			// T1 beim Boxcar: adc_avg mit 1 bis 1024 Samples messen,
+			// Resultat bleibt angezeigt solange T1 gedrueckt ist
+			if (filter.type == ADC_FILTER_BOXCAR
+			        && (CT_BUTTON & AVG_BENCH_MASK)){
+				adc_dma_stop();
+				display_avg_benchmark();
+				while (CT_BUTTON & AVG_BENCH_MASK){}
+				hal_ct_lcd_clear();
+				// restart the selected acquisition mode
+				previous_filter_select = 0xFF;
+				continue;
+			}
 			
-			// S1 ob gefiltert oder nicht
-			if (CT_DIPSW->BYTE.S7_0 & 0x1){
-				value = adc_filter_value(value);
-				// indikator
-				CT_LED->BYTE.LED31_24 = 0xFF;
+			if (oversampling || (acquisition & DMA_MODE_MASK)){
+				value = block_value;
+				
+				// once per second: sample rate and CPU load of the DMA IRQ
+				cycles = CYCLE_COUNTER - rate_start;
+				if (cycles >= CPU_CLOCK_HZ){
+					adc_dma_statistics(&samples, &busy);
+					display_rate_on_lcd(
+					    (uint32_t)((uint64_t)(samples - rate_samples)
+					               * CPU_CLOCK_HZ / cycles),
+					    (uint32_t)((uint64_t)(busy - rate_busy) * 1000u
+					               / cycles));
+					rate_samples = samples;
+					rate_busy = busy;
+					rate_start += cycles;
+				}
 			} else {
-				// indikator aus
-				CT_LED->BYTE.LED31_24 = 0x00;
+				// S24: die naechste Wandlung laeuft, waehrend der letzte
+				// Wert gefiltert und angezeigt wird
+				async_mode = CT_DIPSW->BYTE.S31_24 & ASYNC_MODE_MASK;
+				if (async_mode){
+					if (!async_ready){
+						adc_start_async(resolution, &conversion);
+						async_value = adc_wait_async(&conversion);
+					}
+					value = async_value;
+					adc_start_async(resolution, &conversion);
+					async_pending = 1;
+				} else {
+					value = adc_get_value(resolution);
+				}
+				
+				// Schleifenrate mit und ohne Ueberlappung
+				if (async_mode != previous_async_mode){
+					loop_count = 0;
+					loop_start = CYCLE_COUNTER;
+				}
+				previous_async_mode = async_mode;
+				loop_count++;
+				cycles = CYCLE_COUNTER - loop_start;
+				if (cycles >= CPU_CLOCK_HZ){
+					if (async_mode){
+						async_rate = (uint32_t)((uint64_t)loop_count
+						             * CPU_CLOCK_HZ / cycles);
+						if (!auto_mode){
+							display_overlap_on_lcd(sync_rate, async_rate);
+						}
+					} else {
+						sync_rate = (uint32_t)((uint64_t)loop_count
+						            * CPU_CLOCK_HZ / cycles);
+					}
+					loop_count = 0;
+					loop_start += cycles;
+				}
+				
+				if (auto_mode){
+					// new setting applies from the next conversion on
+					if (adc_auto_update(&controller, value)){
+						adc_set_sample_time(controller.sample_time);
+					}
+					rate_samples++;
+					cycles = CYCLE_COUNTER - rate_start;
+					if (cycles >= CPU_CLOCK_HZ){
+						display_auto_on_lcd((uint32_t)((uint64_t)rate_samples
+						                    * CPU_CLOCK_HZ / cycles));
+						rate_samples = 0;
+						rate_start += cycles;
+					}
+				}
+				
+				start = CYCLE_COUNTER;
+				if (adc_filter_process(&filter, value, &filtered)){
+					cycles = CYCLE_COUNTER - start;
+					if (!auto_mode && !async_mode
+					        && filter.type != ADC_FILTER_MEDIAN){
+						display_cycles_on_lcd(cycles);
+					}
+				}
+				value = filtered;
 			}
 			
+			// indikator: gewaehlter Filter
+			CT_LED->BYTE.LED31_24 = (uint8_t)filter.type;
+			
 			CT_SEG7->BIN.HWORD = value;
-			display_on_lcd(normalize_value(value,resolution));
+			if (oversampling){
+				display_on_lcd(adc_calib_to_mv(&calib, value,
+				               12 + oversample.extra_bits));
+			} else {
+				display_on_lcd(adc_calib_to_mv(&calib, value,
+				               adc_calib_bits(resolution)));
+			}
 			
 		}
     /// END: To be programmed
@@ -127,45 +681,6 @@ int main(void)
 /* -- Local function definitions
  * ------------------------------------------------------------------------- */
 
-/*
- * Normalize value to an integer scale 0 - 3300 (0.0V - 3.3 V)
- *       ADC_RES_6BIT:     value 0 - 63          return 0 - 3300
- *       ADC_RES_8BIT:     value 0 - 255         return 0 - 3300
- *       ADC_RES_10BIT:    value 0 - 1023        return 0 - 3300
- *       ADC_RES_12BIT:    value 0 - 4095        return 0 - 3300
- */
-static uint16_t normalize_value(uint16_t value, adc_resolution_t resolution)
-{
-    /* Use of 32bit -> 4096(12bit) * 3300 = 13'516'800 */
-    uint32_t normalized;
-
-    /// STUDENTS: To be programmed
-		uint16_t s;
-	
-		switch (resolution){
-			case ADC_RES_6BIT:
-					s = 0x3F;
-					break;
-			case ADC_RES_8BIT:
-					s = 0xFF;
-					break;
-			case ADC_RES_10BIT:
-					s = 0x3FF;
-					break;
-			case ADC_RES_12BIT:
-					s = 0xFFF;
-					break;
-			default:
-				s = 0;
-		}
-		
-		normalized = value * 3300 / s;
-		/// END: To be programmeds
-
-    /* Return 16bit value -> max after normalization = 3300 */
-    return (uint16_t)normalized;
-}
-
 /*
  * Display value on LCD display.
  * The data is interpreted and displayed as a fixed point number with
@@ -224,6 +739,614 @@ static void display_on_lcd(uint16_t data_3dec_places)
     hal_ct_lcd_write(0, character_voltage);
 }
 
+/*
+ * Display the cycles needed by the selected filter for one sample on the
+ * second line of the LCD display.
+ */
+static void display_cycles_on_lcd(uint32_t cycles)
+{
+    enum {array_size = 5};
+    char characters[array_size];
+    char line[] = "cycles/sample       ";
+    uint8_t i;
+
+    if (cycles > 9999) {
+        cycles = 9999;
+    }
+    convert_hex_to_ascii((uint16_t)cycles, characters);
+    for (i = 0; i < array_size - 1; i++) {
+        line[14 + i] = characters[i];
+    }
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display the sample rate and the CPU load (0.1 % steps) of the continuous
+ * acquisition on the second line of the LCD display.
+ */
+static void display_rate_on_lcd(uint32_t samples_per_s, uint32_t load_permille)
+{
+    char line[LCD_LINE_LENGTH + 1];
+
+    load_permille = saturate(load_permille, 9999u);
+    (void)snprintf(line, sizeof(line), "%7u S/s %3u.%1u%%  ",
+                   saturate(samples_per_s, 9999999u),
+                   (unsigned)(load_permille / 10),
+                   (unsigned)(load_permille % 10));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display the loop rate of the polled acquisition without and with the
+ * overlapped conversion (S24) and the gain in percent.
+ */
+static void display_overlap_on_lcd(uint32_t sync_rate, uint32_t async_rate)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    int32_t gain = 0;
+
+    if (sync_rate != 0) {
+        gain = (int32_t)(((int64_t)async_rate - (int64_t)sync_rate) * 100
+                         / (int64_t)sync_rate);
+    }
+    (void)snprintf(line, sizeof(line), "%6u %6u/s%+4d%%",
+                   (unsigned)sync_rate, (unsigned)async_rate, (int)gain);
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Median window length from S28..S25: 2^(n+1) - 1 = 1, 3, 7 .. 1023
+ */
+static uint16_t read_median_length(void)
+{
+    uint8_t n = (CT_DIPSW->BYTE.S31_24 & MEDIAN_LENGTH_MASK)
+                >> MEDIAN_LENGTH_SHIFT;
+
+    if (n > MEDIAN_MAX_N) {
+        n = MEDIAN_MAX_N;
+    }
+    return (uint16_t)((2u << n) - 1u);
+}
+
+/*
+ * Display the cycles per sample of the two heap median and of the sort
+ * baseline on the second line of the LCD display.
+ */
+static void display_median_on_lcd(const adc_median_report_t *report)
+{
+    char line[LCD_LINE_LENGTH + 1];
+
+    if (report->mismatches != 0) {
+        (void)snprintf(line, sizeof(line), "N%4u mismatch%6u",
+                       saturate(report->length, 9999u),
+                       saturate(report->mismatches, 999999u));
+    } else {
+        (void)snprintf(line, sizeof(line), "N%4u h%4u s%7u",
+                       saturate(report->length, 9999u),
+                       saturate(report->cycles_heap, 9999u),
+                       saturate(report->cycles_sort, 9999999u));
+    }
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display length and sustained rate of a burst capture on the second line
+ * of the LCD display, e.g. "1024 @ 4200000 S/s".
+ */
+static void display_burst_on_lcd(const adc_capture_result_t *result)
+{
+    char line[LCD_LINE_LENGTH + 1];
+
+    (void)snprintf(line, sizeof(line), "%4u @%8u S/s%c ",
+                   (unsigned)result->nr_of_samples,
+                   (unsigned)result->samples_per_s,
+                   result->overrun ? '!' : ' ');
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display the results of a scan on both lines of the LCD display, e.g.
+ *   "POT1 1650mV VDD 3312"
+ *   "T  31.5C VBAT 3012mV"
+ */
+static void display_scan_on_lcd(const adc_scan_result_t *result)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    int16_t temperature = adc_calib_temperature(&calib, result->temperature);
+    unsigned tenths = saturate((uint32_t)(temperature < 0 ? -temperature
+                                                          : temperature),
+                               9999u);
+
+    (void)snprintf(line, sizeof(line), "POT1 %4umV VDD %4u",
+                   saturate(adc_calib_to_mv(&calib, result->pot1,
+                                            result->pot1_bits), 9999u),
+                   saturate(calib.vdda_mv, 9999u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "T%c%3u.%1uC VBAT %4umV",
+                   (temperature < 0) ? '-' : ' ', tenths / 10u, tenths % 10u,
+                   saturate(4u * adc_calib_to_mv(&calib, result->vbat, 12),
+                            9999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Compare the reciprocal conversion with the division for all values of
+ * 'bits' and display the result, e.g.
+ *   "12b VDD 3312 err 0mV"
+ *   "div  38c  recip  6c "
+ */
+static void display_calib_on_lcd(uint8_t bits)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    adc_calib_report_t report;
+
+    adc_calib_check(&calib, bits, &report);
+    (void)snprintf(line, sizeof(line), "%2ub VDD %4u err%2umV",
+                   saturate(bits, 99u), saturate(calib.vdda_mv, 9999u),
+                   saturate(report.max_error_mv, 99u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "div %3uc  recip %3uc",
+                   saturate(report.cycles_division, 999u),
+                   saturate(report.cycles_reciprocal, 999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display the decision of the auto mode, the number of decisions and the
+ * achieved conversion rate on the second line of the LCD display, e.g.
+ *   "A12b  28c 17 12345/s" (decisions modulo 1000)
+ */
+static void display_auto_on_lcd(uint32_t samples_per_s)
+{
+    static const uint16_t sample_cycles[] = {3, 15, 28, 56, 84, 112, 144, 480};
+    char line[LCD_LINE_LENGTH + 1];
+
+    (void)snprintf(line, sizeof(line), "A%2ub%4uc%3u%6u/s",
+                   saturate(controller.bits, 99u),
+                   saturate(sample_cycles[controller.sample_time], 9999u),
+                   (unsigned)(controller.nr_of_changes % 1000u),
+                   saturate(samples_per_s, 999999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Display one entry of the benchmark table, e.g.
+ *   "12b  28c  823529 S/s"
+ *   "sd    402 uV fast"
+ * "fast" marks the fastest entry within NOISE_BUDGET_UV, "ovr" an entry
+ * where conversions were lost.
+ */
+static void display_bench_on_lcd(const adc_bench_entry_t *entry,
+                                 uint8_t is_fastest)
+{
+    char line[LCD_LINE_LENGTH + 1];
+
+    (void)snprintf(line, sizeof(line), "%2ub %3uc %7u S/s",
+                   saturate(entry->bits, 99u),
+                   saturate(entry->sample_cycles, 999u),
+                   saturate(entry->samples_per_s, 9999999u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "sd %6u uV %-4s   ",
+                   saturate(entry->noise_uv, 999999u),
+                   entry->overrun ? "ovr" : (is_fastest ? "fast" : ""));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Called by the DMA interrupt for every full block: runs the block through
+ * the oversampler or the selected filter and keeps the last output for the
+ * display.
+ */
+static void process_block(const uint16_t *block, uint16_t nr_of_samples)
+{
+    uint16_t output = block_value;
+    uint16_t i;
+
+    if (scoping) {
+        adc_scope_process(&scope, block, nr_of_samples);
+    }
+    if (spectrum) {
+        for (i = 0; i < nr_of_samples && fft_fill < fft_size; i++) {
+            fft_samples[fft_fill++] = block[i];
+        }
+    }
+    if (logging) {
+        adc_log_write(&sample_log, block, nr_of_samples);
+    }
+    if (tones) {
+        adc_goertzel_process(&tone_bank, block, nr_of_samples);
+    }
+    if (metering) {
+        adc_freq_process(&meter, block, nr_of_samples);
+    }
+    if (statistics) {
+        for (i = 0; i < nr_of_samples && stats_fill < stats_size; i++) {
+            stats_samples[stats_fill++] = block[i];
+        }
+    }
+    if (oversampling) {
+        for (i = 0; i < nr_of_samples; i++) {
+            (void)adc_oversample_process(&oversample, block[i], &output);
+        }
+    } else {
+        for (i = 0; i < nr_of_samples; i++) {
+            (void)adc_filter_process(&filter, block[i], &output);
+        }
+    }
+    block_value = output;
+}
+
+/*
+ * Trigger settings from the DIP switches: S15..S8 are the upper 8 bits of
+ * the level, S16 selects the falling slope, S17 the level trigger.
+ */
+static void read_scope_config(adc_scope_config_t *config, uint8_t bits)
+{
+    uint8_t level = CT_DIPSW->BYTE.S15_8;
+    uint8_t options = CT_DIPSW->BYTE.S23_16;
+
+    config->mode = (options & SCOPE_LEVEL_MASK) ? ADC_SCOPE_LEVEL
+                                                : ADC_SCOPE_EDGE;
+    config->slope = (options & SCOPE_FALLING_MASK) ? ADC_SCOPE_FALLING
+                                                   : ADC_SCOPE_RISING;
+    config->level = (bits >= 8) ? (uint16_t)(level << (bits - 8))
+                                : (uint16_t)(level >> (8 - bits));
+    config->hysteresis = (uint16_t)(1u << (bits - 6));  // 1/64 full scale
+    config->window = SCOPE_WINDOW;
+    config->pre_trigger = SCOPE_PRE_TRIGGER;
+    config->holdoff = SCOPE_HOLDOFF;
+}
+
+/*
+ * Renders the captured window: on the 32 LEDs (LED31 = oldest) one column
+ * is lit if its maximum reaches the trigger level, on the LCD the maximum
+ * of 20 columns is shown in four steps over both lines with '_' and '-'.
+ * Returns the LED pattern, the main loop keeps it on the LEDs.
+ */
+static uint32_t display_scope(uint8_t bits)
+{
+    uint16_t minimum[NR_OF_LEDS];
+    uint16_t maximum[NR_OF_LEDS];
+    char top[LCD_LINE_LENGTH + 1];
+    char bottom[LCD_LINE_LENGTH + 1];
+    uint32_t leds = 0;
+    uint8_t step;
+    uint8_t i;
+
+    (void)adc_scope_decimate(&scope, minimum, maximum, NR_OF_LEDS);
+    for (i = 0; i < NR_OF_LEDS; i++) {
+        if (maximum[i] >= scope.config.level) {
+            leds |= 0x1u << (NR_OF_LEDS - 1u - i);
+        }
+    }
+    CT_LED->WORD = leds;
+
+    (void)adc_scope_decimate(&scope, minimum, maximum, LCD_LINE_LENGTH);
+    for (i = 0; i < LCD_LINE_LENGTH; i++) {
+        step = (uint8_t)(((uint32_t)maximum[i] * 4u) >> bits);
+        top[i] = (step >= 3) ? '-' : ((step == 2) ? '_' : ' ');
+        bottom[i] = (step == 1) ? '-' : ((step == 0) ? '_' : ' ');
+    }
+    top[LCD_LINE_LENGTH] = 0;
+    bottom[LCD_LINE_LENGTH] = 0;
+    hal_ct_lcd_write(0, top);
+    hal_ct_lcd_write(LCD_LINE_2, bottom);
+    return leds;
+}
+
+/*
+ * FFT size from S21..S19: 0 = 64 ... 4 and above = 1024 points
+ */
+static uint8_t read_fft_log2(void)
+{
+    uint8_t log2 = ADC_FFT_MIN_LOG2 + ((CT_DIPSW->BYTE.S23_16 & FFT_SIZE_MASK)
+                                       >> FFT_SIZE_SHIFT);
+
+    return (log2 > ADC_FFT_MAX_LOG2) ? ADC_FFT_MAX_LOG2 : log2;
+}
+
+/*
+ * Transforms the collected samples and displays the dominant frequency
+ * and its amplitude, and the time the FFT took, e.g.
+ *   " 1230 Hz   512 mV   "
+ *   "N1024  98765c 1175us"
+ */
+static void display_spectrum(uint8_t log2, uint8_t bits)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t start;
+    uint32_t cycles;
+    uint16_t amplitude;
+    uint16_t bin;
+
+    adc_fft_load(fft_buffer, fft_samples, (uint16_t)(1u << log2), bits);
+    start = CYCLE_COUNTER;
+    adc_fft_forward(fft_buffer, log2);
+    cycles = CYCLE_COUNTER - start;
+    bin = adc_fft_peak(fft_buffer, log2, &amplitude);
+
+    (void)snprintf(line, sizeof(line), "%5u Hz %5u mV   ",
+                   saturate(((uint32_t)bin * FFT_SAMPLE_RATE_HZ) >> log2,
+                            99999u),
+                   saturate(((uint32_t)amplitude * calib.vdda_mv) >> 15,
+                            99999u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "N%4u%7uc%5uus",
+                   saturate(1u << log2, 9999u), saturate(cycles, 9999999u),
+                   saturate(cycles / (CPU_CLOCK_HZ / 1000000u), 99999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Times the FFT for 64, 128, 256, 512 and 1024 points with the DMA
+ * stopped. Line 1 holds the time in us, line 2 the cycles per point,
+ * four digits per size from 64 on the left to 1024 on the right.
+ */
+static void display_fft_benchmark(void)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t cycles[ADC_FFT_NR_OF_SIZES];
+    uint32_t us[ADC_FFT_NR_OF_SIZES];
+    uint32_t per_point[ADC_FFT_NR_OF_SIZES];
+    uint8_t i;
+
+    adc_fft_benchmark(fft_buffer, cycles);
+    for (i = 0; i < ADC_FFT_NR_OF_SIZES; i++) {
+        us[i] = cycles[i] / (CPU_CLOCK_HZ / 1000000u);
+        per_point[i] = cycles[i] >> (ADC_FFT_MIN_LOG2 + i);
+    }
+    (void)snprintf(line, sizeof(line), "%4u%4u%4u%4u%4u",
+                   (unsigned)(us[0] % 10000u), (unsigned)(us[1] % 10000u),
+                   (unsigned)(us[2] % 10000u), (unsigned)(us[3] % 10000u),
+                   (unsigned)(us[4] % 10000u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "%4u%4u%4u%4u%4u",
+                   (unsigned)(per_point[0] % 10000u),
+                   (unsigned)(per_point[1] % 10000u),
+                   (unsigned)(per_point[2] % 10000u),
+                   (unsigned)(per_point[3] % 10000u),
+                   (unsigned)(per_point[4] % 10000u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Times the moving average for 1, 16, 64, 256 and 1024 samples. Line 2
+ * holds the cycles per sample below the lengths on line 1, e.g.
+ *   "avg 1 16 64 256 1024"
+ *   "  22  22  22  22  22"
+ */
+static void display_avg_benchmark(void)
+{
+    char lengths[] = "avg 1 16 64 256 1024";
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t cycles[ADC_AVG_NR_OF_BENCH_LENGTHS];
+
+    adc_avg_benchmark(cycles);
+    hal_ct_lcd_write(0, lengths);
+    (void)snprintf(line, sizeof(line), "%4u%4u%4u%4u%4u",
+                   saturate(cycles[0], 9999u), saturate(cycles[1], 9999u),
+                   saturate(cycles[2], 9999u), saturate(cycles[3], 9999u),
+                   saturate(cycles[4], 9999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * Block size from S21..S19: 0 = 32 ... 7 = 4096 samples
+ */
+static uint16_t read_stats_size(void)
+{
+    return (uint16_t)(1u << (ADC_STATS_MIN_LOG2
+                             + ((CT_DIPSW->BYTE.S23_16 & FFT_SIZE_MASK)
+                                >> FFT_SIZE_SHIFT)));
+}
+
+/*
+ * Computes the statistics of the collected block and displays them in mV
+ * together with the cycles per sample, e.g.
+ *   "mn1602 mx1699 pp  97"
+ *   "av1650 rm1651  1.52c"
+ * The 7 segment display shows the peak to peak value in LSB.
+ */
+static void display_stats(uint16_t nr_of_samples, uint8_t bits)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    adc_stats_t stats;
+    uint32_t start;
+    uint32_t cycles_x100;
+
+    start = CYCLE_COUNTER;
+    adc_stats_block(stats_samples, nr_of_samples, &stats);
+    cycles_x100 = (CYCLE_COUNTER - start) * 100u / nr_of_samples;
+
+    cycles_x100 = saturate(cycles_x100, 99999u);
+    (void)snprintf(line, sizeof(line), "mn%4u mx%4u pp%4u",
+                   saturate(adc_calib_to_mv(&calib, stats.minimum, bits),
+                            9999u),
+                   saturate(adc_calib_to_mv(&calib, stats.maximum, bits),
+                            9999u),
+                   saturate(adc_calib_to_mv(&calib, stats.peak_to_peak,
+                                            bits), 9999u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "av%4u rm%4u%3u.%02uc",
+                   saturate(adc_calib_to_mv(&calib, stats.mean, bits),
+                            9999u),
+                   saturate(adc_calib_to_mv(&calib, stats.rms, bits), 9999u),
+                   (unsigned)(cycles_x100 / 100u),
+                   (unsigned)(cycles_x100 % 100u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+    CT_SEG7->BIN.HWORD = stats.peak_to_peak;
+}
+
+/*
+ * Displays compression ratio and sustained write rate of the log and the
+ * history it holds, e.g.
+ *   "x1.98  1523456 S/s  "
+ *   "hist  1929   0.188s "
+ * The 7 segment display shows the oldest sample, read back from the log.
+ */
+static void display_log(void)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t ratio_x100;
+    uint32_t samples_per_s;
+    uint32_t oldest = sample_log.oldest_sequence;
+    uint32_t history = sample_log.next_sequence - oldest;
+    uint32_t history_ms = history * 1000u / LOG_SAMPLE_RATE_HZ;
+    uint16_t value;
+
+    adc_log_statistics(&sample_log, &ratio_x100, &samples_per_s);
+    // at least one byte per sample: at most x2.00
+    ratio_x100 = saturate(ratio_x100, 999u);
+    history_ms = saturate(history_ms, 999999u);
+    (void)snprintf(line, sizeof(line), "x%u.%02u %8u S/s  ",
+                   (unsigned)(ratio_x100 / 100u),
+                   (unsigned)(ratio_x100 % 100u),
+                   saturate(samples_per_s, 99999999u));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "hist %5u %3u.%03us ",
+                   saturate(history, 99999u),
+                   (unsigned)(history_ms / 1000u),
+                   (unsigned)(history_ms % 1000u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+
+    if (adc_log_read(&sample_log, oldest, &value, 1) == 1) {
+        CT_SEG7->BIN.HWORD = value;
+    }
+}
+
+/*
+ * Sets up the detector bank for the DTMF frequencies at 'bits' resolution.
+ */
+static void init_tones(uint8_t bits)
+{
+    adc_goertzel_config_t config;
+    uint8_t d;
+
+    config.sample_rate_hz = TONE_SAMPLE_RATE_HZ;
+    config.block_length = TONE_BLOCK_LENGTH;
+    config.bits = bits;
+    config.nr_of_detectors = ADC_GOERTZEL_MAX_DETECTORS;
+    for (d = 0; d < ADC_GOERTZEL_MAX_DETECTORS; d++) {
+        config.tone[d].frequency_hz = tone_frequency[d];
+        config.tone[d].threshold = TONE_THRESHOLD;
+        config.tone[d].min_share = TONE_MIN_SHARE;
+    }
+    (void)adc_goertzel_init(&tone_bank, &config);
+}
+
+/*
+ * Displays the last tone that appeared (+) or disappeared (-) with its
+ * amplitude and the key of the tones present now, e.g.
+ *   "+1209Hz  482mV key 1"
+ */
+static void display_tone_event(const adc_goertzel_event_t *event)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint8_t present = tone_bank.present;
+    uint8_t rows = present & ((1u << TONE_NR_OF_ROWS) - 1u);
+    uint8_t columns = (uint8_t)(present >> TONE_NR_OF_ROWS);
+    char key = '-';
+    uint8_t row = 0;
+    uint8_t column = 0;
+
+    // a key needs exactly one row and one column
+    if (rows != 0 && (rows & (rows - 1u)) == 0
+            && columns != 0 && (columns & (columns - 1u)) == 0) {
+        while (!(rows & (1u << row))) {
+            row++;
+        }
+        while (!(columns & (1u << column))) {
+            column++;
+        }
+        key = tone_key[row * TONE_NR_OF_ROWS + column];
+    }
+    (void)snprintf(line, sizeof(line), "%c%4uHz%5umV key %c",
+                   event->present ? '+' : '-',
+                   saturate(tone_frequency[event->detector], 9999u),
+                   saturate(adc_calib_to_mv(&calib, event->amplitude, 12),
+                            99999u),
+                   key);
+    hal_ct_lcd_write(0, line);
+}
+
+/*
+ * Displays block length, number of detectors and the cycles spent per
+ * sample and detector, e.g.
+ *   "205x8    7.8 cyc/S/d"
+ */
+static void display_tone_load(void)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t cycles_x10 = saturate(adc_goertzel_cycles_x10(&tone_bank),
+                                   99999u);
+
+    (void)snprintf(line, sizeof(line), "%3ux%u %4u.%u cyc/S/d",
+                   saturate(tone_bank.config.block_length, 999u),
+                   saturate(tone_bank.config.nr_of_detectors, 9u),
+                   (unsigned)(cycles_x10 / 10u),
+                   (unsigned)(cycles_x10 % 10u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * S21..S19 select the number of periods per measurement, 1 .. 128
+ */
+static uint16_t read_freq_periods(void)
+{
+    return (uint16_t)(1u << ((CT_DIPSW->BYTE.S23_16 & FREQ_PERIODS_MASK)
+                             >> FREQ_PERIODS_SHIFT));
+}
+
+/*
+ * Starts the meter on samples with 'bits' resolution
+ */
+static void init_meter(uint16_t nr_of_periods, uint8_t bits)
+{
+    adc_freq_config_t config;
+
+    config.sample_rate_hz = FREQ_SAMPLE_RATE_HZ;
+    config.nr_of_periods = nr_of_periods;
+    config.hysteresis = (uint16_t)(FREQ_HYSTERESIS >> (12u - bits));
+    config.bits = bits;
+    adc_freq_init(&meter, &config);
+}
+
+/*
+ * Displays frequency, number of periods, period and zero line, e.g.
+ *   "f   997.302Hz  n128 "
+ *   "T  1002.705us 1650mV"
+ */
+static void display_frequency(const adc_freq_result_t *result, uint8_t bits)
+{
+    char line[LCD_LINE_LENGTH + 1];
+    uint32_t frequency_mhz = saturate(result->frequency_mhz, 999999999u);
+    uint32_t period_ns = saturate(result->period_ns, 999999999u);
+
+    if (frequency_mhz == 0) {
+        (void)snprintf(line, sizeof(line), "no signal           ");
+    } else {
+        (void)snprintf(line, sizeof(line), "f%6u.%03uHz  n%3u ",
+                       (unsigned)(frequency_mhz / 1000u),
+                       (unsigned)(frequency_mhz % 1000u),
+                       saturate(result->nr_of_periods, 999u));
+    }
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "T%6u.%03uus %4umV",
+                   (unsigned)(period_ns / 1000u),
+                   (unsigned)(period_ns % 1000u),
+                   saturate(adc_calib_to_mv(&calib, result->level, bits),
+                            9999u));
+    hal_ct_lcd_write(LCD_LINE_2, line);
+}
+
+/*
+ * 'value' limited to 'max', keeps a number within its LCD field
+ */
+static unsigned saturate(uint32_t value, uint32_t max)
+{
+    return (unsigned)(value < max ? value : max);
+}
+
 static void convert_hex_to_ascii(uint16_t hex_value, char* characters){
     uint8_t i = 0;
     uint8_t char_size;
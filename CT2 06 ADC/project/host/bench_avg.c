@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host benchmark of adc_avg_update() for 1 .. 1024 samples.
+ * --
+ * -- One ADC_AVG_DEFINE instance per length 2^0 .. 2^ADC_AVG_MAX_LOG2 runs
+ * -- NR_OF_SAMPLES pseudo random 12 bit samples, timed with the host
+ * -- clock, fastest of NR_OF_RUNS runs. The time per sample should not
+ * -- depend on the length. Every output is compared with the mean of the
+ * -- last 2^n inputs (zeros before the first), the exit code is 1 if one
+ * -- is off. The target times the same function with adc_avg_benchmark()
+ * -- (T1 with the boxcar filter selected).
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* user includes */
+#include "adc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define NR_OF_RUNS          200u
+#define NR_OF_SAMPLES       4096u
+#define NR_OF_LENGTHS       (ADC_AVG_MAX_LOG2 + 1u)
+#define LCG_NEXT(x)         ((x) * 1664525u + 1013904223u)
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+ADC_AVG_DEFINE(avg_1, 0);
+ADC_AVG_DEFINE(avg_2, 1);
+ADC_AVG_DEFINE(avg_4, 2);
+ADC_AVG_DEFINE(avg_8, 3);
+ADC_AVG_DEFINE(avg_16, 4);
+ADC_AVG_DEFINE(avg_32, 5);
+ADC_AVG_DEFINE(avg_64, 6);
+ADC_AVG_DEFINE(avg_128, 7);
+ADC_AVG_DEFINE(avg_256, 8);
+ADC_AVG_DEFINE(avg_512, 9);
+ADC_AVG_DEFINE(avg_1024, 10);
+
+static adc_avg_t *const avg[NR_OF_LENGTHS] = {
+    &avg_1, &avg_2, &avg_4, &avg_8, &avg_16, &avg_32, &avg_64, &avg_128,
+    &avg_256, &avg_512, &avg_1024
+};
+static uint16_t input[NR_OF_SAMPLES];
+static uint16_t output[NR_OF_SAMPLES];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void);
+static int check_output(uint8_t log2);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int errors = 0;
+    uint32_t x = 12345u;
+    double best;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint32_t i;
+    uint8_t log2;
+
+    for (i = 0; i < NR_OF_SAMPLES; i++) {
+        x = LCG_NEXT(x);
+        input[i] = (uint16_t)(x >> 20);
+    }
+
+    printf("samples  per sample [ns]\n");
+    for (log2 = 0; log2 < NR_OF_LENGTHS; log2++) {
+        best = 0.0;
+        for (run = 0; run < NR_OF_RUNS; run++) {
+            adc_avg_reset(avg[log2]);
+            start = now_ns();
+            for (i = 0; i < NR_OF_SAMPLES; i++) {
+                output[i] = adc_avg_update(avg[log2], input[i]);
+            }
+            elapsed = now_ns() - start;
+            if (run == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        printf("%7u  %15.2f\n", 1u << log2, best / NR_OF_SAMPLES);
+        errors |= check_output(log2);
+    }
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * Compares the outputs of the last run with the sum of the last 2^log2
+ * inputs shifted right by log2
+ */
+static int check_output(uint8_t log2)
+{
+    uint32_t length = 1u << log2;
+    uint32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < NR_OF_SAMPLES; i++) {
+        sum += input[i];
+        if (i >= length) {
+            sum -= input[i - length];
+        }
+        if (output[i] != (uint16_t)(sum >> log2)) {
+            printf("%u samples: output %u at %u instead of %u\n",
+                   length, output[i], i, sum >> log2);
+            return 1;
+        }
+    }
+    return 0;
+}
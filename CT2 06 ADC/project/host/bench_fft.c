@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host benchmark of adc_fft_forward() for 64 .. 1024 points.
+ * --
+ * -- The register model traps every CYCCNT access, which makes the times
+ * -- of adc_fft_benchmark() in adc_host useless. Here the portable kernels
+ * -- run without the model and are timed with the host clock, fastest of
+ * -- NR_OF_RUNS runs. Each size also transforms a full scale tone on bin
+ * -- N / 8 + 1 and checks the peak bin and amplitude, the exit code is 1
+ * -- if one is off.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+/* user includes */
+#include "adc_fft.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PI                  3.14159265358979323846
+#define NR_OF_RUNS          1000u
+#define BITS                12u
+#define TONE_PEAK_LSB       2000.0
+#define AMPLITUDE_TOLERANCE 0.01    // of the expected Q15 amplitude
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static int32_t buffer[ADC_FFT_MAX_SIZE];
+static uint16_t samples[ADC_FFT_MAX_SIZE];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void);
+static int check_tone(uint8_t log2);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int errors = 0;
+    double best;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint8_t log2;
+
+    adc_fft_init();
+    printf("points   time [us]  per point [ns]\n");
+    for (log2 = ADC_FFT_MIN_LOG2; log2 <= ADC_FFT_MAX_LOG2; log2++) {
+        best = 0.0;
+        for (run = 0; run < NR_OF_RUNS; run++) {
+            adc_fft_load(buffer, samples, (uint16_t)(1u << log2), BITS);
+            start = now_ns();
+            adc_fft_forward(buffer, log2);
+            elapsed = now_ns() - start;
+            if (run == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        printf("%6u  %10.2f  %14.2f\n", 1u << log2, best / 1000.0,
+               best / (1u << log2));
+        errors |= check_tone(log2);
+    }
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * A tone of TONE_PEAK_LSB on bin N / 8 + 1 must be found on that bin
+ * with 2 |X[k]| / N = TONE_PEAK_LSB in Q15. Leaves the tone in 'samples'
+ * as input of the next timed size.
+ */
+static int check_tone(uint8_t log2)
+{
+    uint32_t n = 1u << log2;
+    uint16_t expected_bin = (uint16_t)(n / 8u + 1u);
+    double expected = TONE_PEAK_LSB * (1u << (15u - BITS));
+    uint16_t amplitude;
+    uint16_t bin;
+    uint32_t i;
+
+    for (i = 0; i < ADC_FFT_MAX_SIZE; i++) {
+        samples[i] = (uint16_t)lround(2048.0 + TONE_PEAK_LSB
+                                      * sin(2.0 * PI * expected_bin * i / n));
+    }
+    adc_fft_load(buffer, samples, (uint16_t)n, BITS);
+    adc_fft_forward(buffer, log2);
+    bin = adc_fft_peak(buffer, log2, &amplitude);
+    if (bin != expected_bin
+            || fabs(amplitude - expected) > AMPLITUDE_TOLERANCE * expected) {
+        printf("%u points: bin %u amplitude %u instead of %u and %.0f\n",
+               n, bin, amplitude, expected_bin, expected);
+        return 1;
+    }
+    return 0;
+}
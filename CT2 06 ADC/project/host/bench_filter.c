@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host benchmark of adc_filter_process() for every type.
+ * --
+ * -- Each filter of the bank (none, boxcar, EMA, biquad, CIC, median with
+ * -- ADC_FILTER_MEDIAN_LENGTH) runs the same NR_OF_SAMPLES input: a level
+ * -- of LEVEL_LSB with +-NOISE_LSB of pseudo random noise and a spike of
+ * -- alternating sign every SPIKE_DISTANCE samples. The time per input
+ * -- sample is the fastest of NR_OF_RUNS runs with the host clock. The
+ * -- mean of the outputs of the second half must be within MEAN_TOLERANCE
+ * -- of the level, the exit code is 1 if one is off.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+/* user includes */
+#include "adc_filter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define NR_OF_RUNS          200u
+#define NR_OF_SAMPLES       4096u
+#define LEVEL_LSB           2000u
+#define NOISE_LSB           8u          // uniform, +-
+#define SPIKE_LSB           1000u
+#define SPIKE_DISTANCE      64u
+#define MEAN_TOLERANCE      4.0         // LSB
+#define LCG_NEXT(x)         ((x) * 1664525u + 1013904223u)
+#define NR_OF_TYPES         (sizeof(type) / sizeof(type[0]))
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const struct {
+    adc_filter_type_t type;
+    const char *name;
+} type[] = {
+    { ADC_FILTER_NONE, "none" },
+    { ADC_FILTER_BOXCAR, "boxcar" },
+    { ADC_FILTER_EMA, "EMA" },
+    { ADC_FILTER_BIQUAD, "biquad" },
+    { ADC_FILTER_CIC, "CIC" },
+    { ADC_FILTER_MEDIAN, "median" }
+};
+static adc_filter_t filter;
+static uint16_t input[NR_OF_SAMPLES];
+static uint16_t output[NR_OF_SAMPLES];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void);
+static void make_input(void);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int errors = 0;
+    double best;
+    double start;
+    double elapsed;
+    double mean;
+    uint32_t outputs = 0;
+    uint32_t run;
+    uint32_t i;
+    uint32_t t;
+
+    make_input();
+    printf("filter   outputs  per sample [ns]  mean [LSB]\n");
+    for (t = 0; t < NR_OF_TYPES; t++) {
+        best = 0.0;
+        for (run = 0; run < NR_OF_RUNS; run++) {
+            adc_filter_init(&filter, type[t].type);
+            outputs = 0;
+            start = now_ns();
+            for (i = 0; i < NR_OF_SAMPLES; i++) {
+                outputs += adc_filter_process(&filter, input[i],
+                                              &output[outputs]);
+            }
+            elapsed = now_ns() - start;
+            if (run == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        mean = 0.0;
+        for (i = outputs / 2u; i < outputs; i++) {
+            mean += output[i];
+        }
+        mean /= outputs - outputs / 2u;
+        printf("%-7s  %7u  %15.2f  %10.1f%s\n", type[t].name, outputs,
+               best / NR_OF_SAMPLES, mean,
+               fabs(mean - LEVEL_LSB) > MEAN_TOLERANCE ? "!" : "");
+        if (fabs(mean - LEVEL_LSB) > MEAN_TOLERANCE) {
+            errors = 1;
+        }
+    }
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * Noisy level with spikes of alternating sign, so the spikes do not move
+ * the mean of the linear filters
+ */
+static void make_input(void)
+{
+    uint32_t x = 12345u;
+    uint32_t i;
+
+    for (i = 0; i < NR_OF_SAMPLES; i++) {
+        x = LCG_NEXT(x);
+        input[i] = (uint16_t)(LEVEL_LSB - NOISE_LSB
+                              + (x >> 16) % (2u * NOISE_LSB + 1u));
+        if (i % SPIKE_DISTANCE == SPIKE_DISTANCE - 1u) {
+            input[i] = (i / SPIKE_DISTANCE) & 0x1u
+                       ? (uint16_t)(input[i] - SPIKE_LSB)
+                       : (uint16_t)(input[i] + SPIKE_LSB);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host benchmark of adc_median_update() against qsort.
+ * --
+ * -- For the window lengths 2^(n+1) - 1 of S28..S25 in main.c,
+ * -- NR_OF_SAMPLES pseudo random 12 bit samples run through the two heap
+ * -- update after the window is full, and through a copy of the window
+ * -- sorted with qsort per sample. The time per sample is the fastest of
+ * -- NR_OF_RUNS runs with the host clock. adc_median_benchmark() gives the
+ * -- same comparison in cycles on the target, host/test_median.c checks
+ * -- the outputs.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* user includes */
+#include "adc_median.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define NR_OF_RUNS          5u
+#define NR_OF_SAMPLES       2048u
+#define MAX_N               9u          // MEDIAN_MAX_N of main.c
+#define LCG_NEXT(x)         ((x) * 1664525u + 1013904223u)
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static adc_median_t median;
+static uint16_t input[ADC_MEDIAN_MAX_LENGTH + NR_OF_SAMPLES];
+static uint16_t window[ADC_MEDIAN_MAX_LENGTH];
+static uint16_t sorted[ADC_MEDIAN_MAX_LENGTH];
+static volatile uint16_t sink;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void);
+static double time_heap(uint16_t length);
+static double time_sort(uint16_t length);
+static int compare(const void *a, const void *b);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    uint32_t x = 12345u;
+    double heap;
+    double sort;
+    uint32_t i;
+    uint16_t length;
+    uint8_t n;
+
+    for (i = 0; i < ADC_MEDIAN_MAX_LENGTH + NR_OF_SAMPLES; i++) {
+        x = LCG_NEXT(x);
+        input[i] = (uint16_t)(x >> 20);
+    }
+
+    printf("length  heap [ns]  qsort [ns]  ratio\n");
+    for (n = 0; n <= MAX_N; n++) {
+        length = (uint16_t)((2u << n) - 1u);
+        heap = time_heap(length);
+        sort = time_sort(length);
+        printf("%6u  %9.1f  %10.1f  %5.1f\n", length, heap, sort,
+               sort / heap);
+    }
+    return 0;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * ns per adc_median_update() once the window of 'length' is full
+ */
+static double time_heap(uint16_t length)
+{
+    double best = 0.0;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint32_t i;
+
+    for (run = 0; run < NR_OF_RUNS; run++) {
+        adc_median_init(&median, length);
+        for (i = 0; i < length; i++) {
+            (void)adc_median_update(&median, input[i]);
+        }
+        start = now_ns();
+        for (i = length; i < length + NR_OF_SAMPLES; i++) {
+            sink = adc_median_update(&median, input[i]);
+        }
+        elapsed = now_ns() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / NR_OF_SAMPLES;
+}
+
+/*
+ * ns per sample to replace the oldest sample of the window of 'length',
+ * copy the window and qsort the copy
+ */
+static double time_sort(uint16_t length)
+{
+    double best = 0.0;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint32_t i;
+    uint16_t oldest;
+
+    for (run = 0; run < NR_OF_RUNS; run++) {
+        memcpy(window, input, length * sizeof(window[0]));
+        oldest = 0;
+        start = now_ns();
+        for (i = length; i < length + NR_OF_SAMPLES; i++) {
+            window[oldest] = input[i];
+            oldest = (oldest + 1u == length) ? 0 : oldest + 1u;
+            memcpy(sorted, window, length * sizeof(sorted[0]));
+            qsort(sorted, length, sizeof(sorted[0]), compare);
+            sink = sorted[length / 2u];
+        }
+        elapsed = now_ns() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / NR_OF_SAMPLES;
+}
+
+static int compare(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host version of the LCD HAL, implemented in sim_board.c.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _HAL_CT_LCD_H
+#define _HAL_CT_LCD_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef enum {
+    HAL_LCD_RED,
+    HAL_LCD_GREEN,
+    HAL_LCD_BLUE
+} hal_ct_lcd_color_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Writes 'text' to the 40 character buffer starting at 'position'.
+ * Characters 0..19 are line 1, 20..39 line 2.
+ */
+void hal_ct_lcd_write(uint8_t position, char text[]);
+
+/*
+ * Clears both lines.
+ */
+void hal_ct_lcd_clear(void);
+
+/*
+ * Background light, ignored on the host.
+ */
+void hal_ct_lcd_color(hal_ct_lcd_color_t color, uint16_t value);
+
+#endif
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host version of the FMC HAL, implemented in sim_board.c.
+ * --
+ * -- The external SRAM is mapped as plain memory, initialisation is a no-op.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _HAL_FMC_H
+#define _HAL_FMC_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef enum {
+    DISABLE = 0,
+    ENABLE
+} hal_bool_t;
+
+typedef enum {
+    HAL_FMC_SRAM_BANK1,
+    HAL_FMC_SRAM_BANK2,
+    HAL_FMC_SRAM_BANK3,
+    HAL_FMC_SRAM_BANK4
+} hal_fmc_sram_bank_t;
+
+typedef enum {
+    HAL_FMC_TYPE_SRAM,
+    HAL_FMC_TYPE_PSRAM,
+    HAL_FMC_TYPE_NOR
+} hal_fmc_type_t;
+
+typedef enum {
+    HAL_FMC_WIDTH_8B,
+    HAL_FMC_WIDTH_16B,
+    HAL_FMC_WIDTH_32B
+} hal_fmc_width_t;
+
+typedef struct {
+    hal_bool_t address_mux;
+    hal_fmc_type_t type;
+    hal_fmc_width_t width;
+    hal_bool_t write_enable;
+} hal_fmc_sram_init_t;
+
+typedef struct {
+    uint8_t address_setup;
+    uint8_t address_hold;
+    uint8_t data_setup;
+} hal_fmc_sram_timing_t;
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Configures an SRAM bank of the FMC.
+ */
+void hal_fmc_init_sram(hal_fmc_sram_bank_t bank, hal_fmc_sram_init_t init,
+                       hal_fmc_sram_timing_t timing);
+
+#endif
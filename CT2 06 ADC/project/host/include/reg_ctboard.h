@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host version of the CT board header for the register model.
+ * --
+ * -- The board peripherals are plain memory at their FMC addresses. The
+ * -- simulator sets the switches and prints LEDs and 7-segment display.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _REG_CTBOARD_H
+#define _REG_CTBOARD_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Register types
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    union {
+        volatile uint32_t WORD;
+        struct {
+            volatile uint16_t LED15_0;
+            volatile uint16_t LED31_16;
+        } HWORD;
+        struct {
+            volatile uint8_t LED7_0;
+            volatile uint8_t LED15_8;
+            volatile uint8_t LED23_16;
+            volatile uint8_t LED31_24;
+        } BYTE;
+    };
+} reg_ct_led_t;
+
+typedef struct {
+    union {
+        volatile uint32_t WORD;
+        struct {
+            volatile uint8_t DS0;
+            volatile uint8_t DS1;
+            volatile uint8_t DS2;
+            volatile uint8_t DS3;
+        } BYTE;
+    } RAW;
+    union {
+        volatile uint32_t WORD;
+        volatile uint16_t HWORD;
+    } BIN;
+} reg_ct_seg7_t;
+
+typedef struct {
+    union {
+        volatile uint32_t WORD;
+        struct {
+            volatile uint16_t S15_0;
+            volatile uint16_t S31_16;
+        } HWORD;
+        struct {
+            volatile uint8_t S7_0;
+            volatile uint8_t S15_8;
+            volatile uint8_t S23_16;
+            volatile uint8_t S31_24;
+        } BYTE;
+    };
+} reg_ct_dipsw_t;
+
+
+/* -- Register instances
+ * ------------------------------------------------------------------------- */
+
+#define CT_LED      ((reg_ct_led_t *) 0x60000100)
+#define CT_SEG7     ((reg_ct_seg7_t *) 0x60000110)
+#define CT_DIPSW    ((reg_ct_dipsw_t *) 0x60000200)
+#define CT_BUTTON   (*((volatile uint8_t *) 0x60000210))
+#define CT_HEXSW    (*((volatile uint8_t *) 0x60000211))
+
+#endif
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host version of the device header for the register model.
+ * --
+ * -- Only the registers used by the ADC lab, with the layout and addresses
+ * -- of the STM32F429. sim_board.c maps these addresses into the process.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _REG_STM32F4XX_H
+#define _REG_STM32F4XX_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Register types
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    volatile uint32_t SR;
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SMPR1;
+    volatile uint32_t SMPR2;
+    volatile uint32_t JOFR1;
+    volatile uint32_t JOFR2;
+    volatile uint32_t JOFR3;
+    volatile uint32_t JOFR4;
+    volatile uint32_t HTR;
+    volatile uint32_t LTR;
+    volatile uint32_t SQR1;
+    volatile uint32_t SQR2;
+    volatile uint32_t SQR3;
+    volatile uint32_t JSQR;
+    volatile uint32_t JDR1;
+    volatile uint32_t JDR2;
+    volatile uint32_t JDR3;
+    volatile uint32_t JDR4;
+    volatile uint32_t DR;
+} reg_adc_t;
+
+typedef struct {
+    volatile uint32_t CSR;
+    volatile uint32_t CCR;
+    volatile uint32_t CDR;
+} reg_adccom_t;
+
+typedef struct {
+    volatile uint32_t CR;
+    volatile uint32_t PLLCFGR;
+    volatile uint32_t CFGR;
+    volatile uint32_t CIR;
+    volatile uint32_t AHB1RSTR;
+    volatile uint32_t AHB2RSTR;
+    volatile uint32_t AHB3RSTR;
+    uint32_t reserved0;
+    volatile uint32_t APB1RSTR;
+    volatile uint32_t APB2RSTR;
+    uint32_t reserved1[2];
+    volatile uint32_t AHB1ENR;
+    volatile uint32_t AHB2ENR;
+    volatile uint32_t AHB3ENR;
+    uint32_t reserved2;
+    volatile uint32_t APB1ENR;
+    volatile uint32_t APB2ENR;
+} reg_rcc_t;
+
+typedef struct {
+    volatile uint32_t MODER;
+    volatile uint32_t OTYPER;
+    volatile uint32_t OSPEEDR;
+    volatile uint32_t PUPDR;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t LCKR;
+    volatile uint32_t AFRL;
+    volatile uint32_t AFRH;
+} reg_gpio_t;
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SMCR;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t EGR;
+    volatile uint32_t CCMR1;
+    volatile uint32_t CCMR2;
+    volatile uint32_t CCER;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t RCR;
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+    volatile uint32_t CCR3;
+    volatile uint32_t CCR4;
+    volatile uint32_t BDTR;
+    volatile uint32_t DCR;
+    volatile uint32_t DMAR;
+} reg_tim_t;
+
+
+/* -- Register instances
+ * ------------------------------------------------------------------------- */
+
+#define TIM2        ((reg_tim_t *) 0x40000000)
+#define ADC1        ((reg_adc_t *) 0x40012000)
+#define ADC2        ((reg_adc_t *) 0x40012100)
+#define ADC3        ((reg_adc_t *) 0x40012200)
+#define ADCCOM      ((reg_adccom_t *) 0x40012300)
+#define GPIOA       ((reg_gpio_t *) 0x40020000)
+#define GPIOB       ((reg_gpio_t *) 0x40020400)
+#define GPIOC       ((reg_gpio_t *) 0x40020800)
+#define GPIOD       ((reg_gpio_t *) 0x40020C00)
+#define GPIOE       ((reg_gpio_t *) 0x40021000)
+#define GPIOF       ((reg_gpio_t *) 0x40021400)
+#define GPIOG       ((reg_gpio_t *) 0x40021800)
+#define RCC         ((reg_rcc_t *) 0x40023800)
+
+#endif
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of the host register model of the ADC lab.
+ * --
+ * -- sim_board.c  memory map, access traps, timer tick and main()
+ * -- sim_adc.c    ADC1..3, DMA2 and TIM2 trigger model
+ * -- sim_wave.c   WAV/CSV waveform playback, synthetic sine
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* re-definition guard */
+#ifndef _SIM_H
+#define _SIM_H
+
+/* standard includes */
+#include <stdint.h>
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define SIM_CPU_CLOCK_HZ    84000000u
+#define SIM_APB2_CLOCK_HZ   42000000u
+#define SIM_VDDA            3.3
+
+/* Trapped pages: every access goes through the model */
+#define SIM_ADC_PAGE        0x40012000u
+#define SIM_DWT_PAGE        0xE0001000u
+#define SIM_PAGE_SIZE       0x1000u
+
+
+/* -- Public function declarations
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Simulated time in ns since the start of the firmware
+ */
+uint64_t sim_now_ns(void);
+
+/*
+ * Resets the model, to be called with the registers mapped.
+ */
+void sim_adc_reset(double noise_lsb);
+
+/*
+ * Advances the ADCs, the DMA and the timer trigger to 'now_ns'.
+ */
+void sim_adc_advance(uint64_t now_ns);
+
+/*
+ * Called around a trapped access of the ADC page: 'after' = 0 before the
+ * instruction, 1 after it.
+ */
+void sim_adc_access(uint32_t address, int is_write, int after);
+
+/*
+ * Returns 1 if DMA2 stream 'stream' has an enabled interrupt flag set.
+ */
+int sim_dma_irq_pending(unsigned stream);
+
+/*
+ * Returns 1 if one of the ADCs has EOC or JEOC set with the interrupt
+ * enabled.
+ */
+int sim_adc_irq_pending(void);
+
+/*
+ * Time of the next conversion that ends with an enabled EOC or JEOC
+ * interrupt, UINT64_MAX if there is none.
+ */
+uint64_t sim_adc_next_irq_ns(void);
+
+/*
+ * Number of conversions since the start
+ */
+uint64_t sim_adc_conversions(void);
+
+/*
+ * Loads a WAV (PCM 8/16 bit, first channel) or CSV file (one voltage per
+ * line, 'csv_rate_hz' samples per second), or sets up a synthetic sine
+ * for "sine:<Hz>[:<V peak>]". Returns 0 on success.
+ */
+int sim_wave_load(const char *path, uint32_t csv_rate_hz);
+
+/*
+ * Input voltage at 't_ns', repeats the waveform if 'loop' was set.
+ */
+double sim_wave_voltage(uint64_t t_ns);
+
+/*
+ * Duration of the waveform in ns
+ */
+uint64_t sim_wave_duration_ns(void);
+
+#endif
@@ -0,0 +1,679 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  ADC, DMA2 and TIM2 trigger model of the host simulator.
+ * --
+ * -- The ADC and DMA pages are trapped by sim_board.c, so every register
+ * -- access calls sim_adc_access() with the model advanced to the current
+ * -- time. Modelled are
+ * --  - regular sequences (SWSTART, CONT, SCAN) and TIM2 TRGO triggers
+ * --  - injected sequences (JSWSTART) into JDR1..4
+ * --  - dual/triple interleaved mode of ADC1 with DMA mode 1 and 2 on CDR
+ * --  - DMA2 streams in peripheral to memory mode with HT/TC flags and CIRC
+ * --  - OVR when a regular conversion ends before DR was read (DMA or EOCS)
+ * -- Conversion time is sampling time + resolution in ADC clock cycles.
+ * -- Channels 4 (POT1) and 10 (PC.0) see the waveform, 17 VREFINT and
+ * -- 18 the temperature sensor or VBAT/4. Not modelled: watchdog,
+ * -- DMA double buffer and FIFO.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <math.h>
+
+/* user includes */
+#include "sim.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define REG(address)        (*((volatile uint32_t *)(uintptr_t)(address)))
+#define NEVER               UINT64_MAX
+
+/* ADC register offsets */
+#define ADC_BASE(n)         (SIM_ADC_PAGE + 0x100u * (n))
+#define ADC_SR              0x00u
+#define ADC_CR1             0x04u
+#define ADC_CR2             0x08u
+#define ADC_SMPR1           0x0Cu
+#define ADC_SMPR2           0x10u
+#define ADC_SQR1            0x2Cu
+#define ADC_SQR2            0x30u
+#define ADC_SQR3            0x34u
+#define ADC_JSQR            0x38u
+#define ADC_JDR1            0x3Cu
+#define ADC_DR              0x4Cu
+#define ADC_CCR             (SIM_ADC_PAGE + 0x304u)
+#define ADC_CDR             (SIM_ADC_PAGE + 0x308u)
+
+#define SR_EOC              (0x1u << 1)
+#define SR_JEOC             (0x1u << 2)
+#define SR_JSTRT            (0x1u << 3)
+#define SR_STRT             (0x1u << 4)
+#define SR_OVR              (0x1u << 5)
+#define SR_FLAGS            0x3Fu
+#define CR1_EOCIE           (0x1u << 5)
+#define CR1_JEOCIE          (0x1u << 7)
+#define CR1_SCAN            (0x1u << 8)
+#define CR2_ADON            (0x1u << 0)
+#define CR2_CONT            (0x1u << 1)
+#define CR2_DMA             (0x1u << 8)
+#define CR2_EOCS            (0x1u << 10)
+#define CR2_JSWSTART        (0x1u << 22)
+#define CR2_SWSTART         (0x1u << 30)
+#define CR2_EXTSEL(cr2)     (((cr2) >> 24) & 0xFu)
+#define CR2_EXTEN(cr2)      (((cr2) >> 28) & 0x3u)
+#define EXTSEL_TIM2_TRGO    0x6u
+#define CCR_MULTI(ccr)      ((ccr) & 0x1Fu)
+#define CCR_DELAY(ccr)      (((ccr) >> 8) & 0xFu)
+#define CCR_DMA(ccr)        (((ccr) >> 14) & 0x3u)
+#define CCR_ADCPRE(ccr)     (((ccr) >> 16) & 0x3u)
+#define CCR_VBATE           (0x1u << 22)
+#define CCR_TSVREFE         (0x1u << 23)
+
+#define CHANNEL_POT1        4u
+#define CHANNEL_PC0         10u
+#define CHANNEL_VREFINT     17u
+#define CHANNEL_TEMP_VBAT   18u
+#define VREFINT_V           1.21
+#define TS_V25              0.76
+#define TS_SLOPE_V          0.0025
+#define TEMPERATURE         25.0
+#define VBAT_V              3.0
+
+/* DMA2 */
+#define DMA2_BASE           0x40026400u
+#define DMA_ISR(s)          (DMA2_BASE + ((s) < 4u ? 0x00u : 0x04u))
+#define DMA_IFCR(s)         (DMA2_BASE + ((s) < 4u ? 0x08u : 0x0Cu))
+#define DMA_FLAG_SHIFT(s)   (flag_shift[(s) & 0x3u])
+#define DMA_CR(s)           (DMA2_BASE + 0x10u + 0x18u * (s))
+#define DMA_NDTR(s)         (DMA_CR(s) + 0x04u)
+#define DMA_PAR(s)          (DMA_CR(s) + 0x08u)
+#define DMA_M0AR(s)         (DMA_CR(s) + 0x0Cu)
+#define DMA_NR_OF_STREAMS   8u
+#define DMA_CR_EN           (0x1u << 0)
+#define DMA_CR_TEIE         (0x1u << 2)
+#define DMA_CR_HTIE         (0x1u << 3)
+#define DMA_CR_TCIE         (0x1u << 4)
+#define DMA_CR_CIRC         (0x1u << 8)
+#define DMA_CR_MINC         (0x1u << 10)
+#define DMA_CR_MSIZE(cr)    (((cr) >> 13) & 0x3u)
+#define DMA_TEIF            (0x1u << 3)
+#define DMA_HTIF            (0x1u << 4)
+#define DMA_TCIF            (0x1u << 5)
+
+/* TIM2 */
+#define TIM2_CR1            REG(0x40000000u)
+#define TIM2_PSC            REG(0x40000028u)
+#define TIM2_ARR            REG(0x4000002Cu)
+#define TIM_CR1_CEN         (0x1u << 0)
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t regular_active;
+    uint8_t sequence_index;
+    uint8_t triggered;
+    uint8_t injected_active;
+    uint64_t regular_done_ns;
+    uint64_t injected_done_ns;
+    uint64_t next_trigger;          // index of the next TIM2 update
+    uint64_t interval_ns;           // interleaved mode: master to master
+} adc_model_t;
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const uint16_t sample_cycles[8] = { 3, 15, 28, 56, 84, 112, 144, 480 };
+static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+static adc_model_t adcs[3];
+static uint32_t dma_initial[DMA_NR_OF_STREAMS];
+static uint32_t multi_low;              // first half of a DMA mode 2 word
+static uint8_t multi_half;
+static uint8_t tim_running;
+static uint64_t tim_start_ns;
+static uint64_t conversions;
+static double noise;
+static uint32_t random_state = 2463534242u;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void advance_adc(unsigned n, uint64_t now_ns);
+static void start_regular(unsigned n, uint64_t t_ns);
+static void complete_regular(unsigned n);
+static void start_injected(unsigned n, uint64_t t_ns);
+static void complete_injected(unsigned n);
+static unsigned regular_channel(unsigned n, unsigned index);
+static uint64_t conversion_ns(unsigned n, unsigned channel);
+static uint32_t adc_clock_hz(void);
+static uint64_t trigger_ns(uint64_t index);
+static int is_triggered(unsigned n);
+static int is_master(unsigned n);
+static uint32_t convert(unsigned n, unsigned channel, uint64_t t_ns);
+static void dma_request(uint32_t peripheral, uint32_t value);
+static double gauss(void);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+void sim_adc_reset(double noise_lsb)
+{
+    unsigned n;
+
+    for (n = 0; n < 3u; n++) {
+        adcs[n] = (adc_model_t){ 0 };
+    }
+    noise = noise_lsb;
+    tim_running = 0;
+    conversions = 0;
+}
+
+
+/*
+ *  See header file
+ */
+void sim_adc_advance(uint64_t now_ns)
+{
+    unsigned n;
+
+    if ((TIM2_CR1 & TIM_CR1_CEN) && !tim_running) {
+        tim_running = 1;
+        tim_start_ns = now_ns;
+        for (n = 0; n < 3u; n++) {
+            adcs[n].triggered = 0;
+        }
+    } else if (!(TIM2_CR1 & TIM_CR1_CEN)) {
+        tim_running = 0;
+    }
+
+    for (n = 0; n < 3u; n++) {
+        advance_adc(n, now_ns);
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void sim_adc_access(uint32_t address, int is_write, int after)
+{
+    static uint32_t old;
+    uint64_t now_ns = sim_now_ns();
+    uint32_t reg = address & ~0x3u;
+    uint32_t value;
+    unsigned n;
+    unsigned s;
+
+    if (!after) {
+        old = REG(reg);
+        return;
+    }
+    value = REG(reg);
+
+    if (reg >= DMA2_BASE && reg < DMA_CR(DMA_NR_OF_STREAMS)) {
+        if (!is_write) {
+            return;
+        }
+        for (s = 0; s < DMA_NR_OF_STREAMS; s += 4u) {
+            if (reg == DMA_ISR(s)) {
+                REG(reg) = old;                         // read only
+            } else if (reg == DMA_IFCR(s)) {
+                REG(DMA_ISR(s)) &= ~value;
+                REG(reg) = 0;
+            }
+        }
+        for (s = 0; s < DMA_NR_OF_STREAMS; s++) {
+            if (reg == DMA_CR(s) && (value & DMA_CR_EN)
+                    && !(old & DMA_CR_EN)) {
+                dma_initial[s] = REG(DMA_NDTR(s)) & 0xFFFFu;
+            }
+        }
+        return;
+    }
+
+    if (reg < SIM_ADC_PAGE || reg >= ADC_BASE(3)) {
+        return;
+    }
+    n = (reg - SIM_ADC_PAGE) / 0x100u;
+
+    switch (reg - ADC_BASE(n)) {
+    case ADC_SR:
+        if (is_write) {
+            REG(reg) = old & (value | ~SR_FLAGS);   // rc_w0
+        }
+        break;
+    case ADC_DR:
+        if (!is_write) {
+            REG(ADC_BASE(n) + ADC_SR) &= ~SR_EOC;
+        }
+        break;
+    case ADC_CR2:
+        if (!is_write) {
+            break;
+        }
+        if (!(value & CR2_ADON)) {
+            adcs[n].regular_active = 0;
+            adcs[n].injected_active = 0;
+            break;
+        }
+        if (value & CR2_SWSTART) {
+            REG(reg) = value & ~CR2_SWSTART;
+            if (!adcs[n].regular_active) {
+                start_regular(n, now_ns);
+            }
+        }
+        if (value & CR2_JSWSTART) {
+            REG(reg) &= ~CR2_JSWSTART;
+            if (!adcs[n].injected_active) {
+                start_injected(n, now_ns);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+int sim_dma_irq_pending(unsigned stream)
+{
+    uint32_t flags = REG(DMA_ISR(stream)) >> DMA_FLAG_SHIFT(stream);
+    uint32_t cr = REG(DMA_CR(stream));
+
+    return ((cr & DMA_CR_TCIE) && (flags & DMA_TCIF))
+        || ((cr & DMA_CR_HTIE) && (flags & DMA_HTIF))
+        || ((cr & DMA_CR_TEIE) && (flags & DMA_TEIF));
+}
+
+
+/*
+ *  See header file
+ */
+int sim_adc_irq_pending(void)
+{
+    unsigned n;
+
+    for (n = 0; n < 3u; n++) {
+        uint32_t sr = REG(ADC_BASE(n) + ADC_SR);
+        uint32_t cr1 = REG(ADC_BASE(n) + ADC_CR1);
+
+        if (((cr1 & CR1_EOCIE) && (sr & SR_EOC))
+                || ((cr1 & CR1_JEOCIE) && (sr & SR_JEOC))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ *  See header file
+ */
+uint64_t sim_adc_next_irq_ns(void)
+{
+    uint64_t next_ns = NEVER;
+    unsigned n;
+
+    for (n = 0; n < 3u; n++) {
+        uint32_t cr1 = REG(ADC_BASE(n) + ADC_CR1);
+
+        if ((cr1 & CR1_EOCIE) && adcs[n].regular_active
+                && adcs[n].regular_done_ns < next_ns) {
+            next_ns = adcs[n].regular_done_ns;
+        }
+        if ((cr1 & CR1_JEOCIE) && adcs[n].injected_active
+                && adcs[n].injected_done_ns < next_ns) {
+            next_ns = adcs[n].injected_done_ns;
+        }
+    }
+    return next_ns;
+}
+
+
+/*
+ *  See header file
+ */
+uint64_t sim_adc_conversions(void)
+{
+    return conversions;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Processes completions and TIM2 triggers of ADC 'n' in time order.
+ */
+static void advance_adc(unsigned n, uint64_t now_ns)
+{
+    adc_model_t *adc = &adcs[n];
+    uint64_t done;
+    uint64_t trigger;
+
+    if (!(REG(ADC_BASE(n) + ADC_CR2) & CR2_ADON)) {
+        adc->regular_active = 0;
+        adc->injected_active = 0;
+        return;
+    }
+
+    if (is_triggered(n) && !adc->triggered) {
+        adc->triggered = 1;
+        adc->next_trigger = 0;
+        while (trigger_ns(adc->next_trigger) <= now_ns) {
+            adc->next_trigger++;
+        }
+    } else if (!is_triggered(n)) {
+        adc->triggered = 0;
+    }
+
+    if (adc->injected_active && adc->injected_done_ns <= now_ns) {
+        complete_injected(n);
+    }
+
+    for (;;) {
+        done = adc->regular_active ? adc->regular_done_ns : NEVER;
+        trigger = adc->triggered ? trigger_ns(adc->next_trigger) : NEVER;
+        if (done > now_ns && trigger > now_ns) {
+            break;
+        }
+        if (done <= trigger) {
+            complete_regular(n);
+        } else {
+            adc->next_trigger++;
+            if (!adc->regular_active) {
+                start_regular(n, trigger);
+            }
+        }
+    }
+}
+
+static void start_regular(unsigned n, uint64_t t_ns)
+{
+    adc_model_t *adc = &adcs[n];
+    uint64_t tconv = conversion_ns(n, regular_channel(n, 0));
+
+    if (is_master(n)) {
+        /* Interleaved: the ADCs start 'DELAY' cycles after each other */
+        uint32_t ccr = REG(ADC_CCR);
+        uint64_t nr_of_adcs = (CCR_MULTI(ccr) >= 0x10u) ? 3u : 2u;
+        uint64_t delay = (CCR_DELAY(ccr) + 5u) * 1000000000ull
+                         / adc_clock_hz();
+
+        tconv /= nr_of_adcs;
+        if (tconv < delay) {
+            tconv = delay;
+        }
+        multi_half = 0;
+        adc->interval_ns = tconv;
+    }
+    adc->regular_active = 1;
+    adc->sequence_index = 0;
+    adc->regular_done_ns = t_ns + tconv;
+    REG(ADC_BASE(n) + ADC_SR) |= SR_STRT;
+}
+
+static void complete_regular(unsigned n)
+{
+    adc_model_t *adc = &adcs[n];
+    uint32_t base = ADC_BASE(n);
+    uint32_t cr1 = REG(base + ADC_CR1);
+    uint32_t cr2 = REG(base + ADC_CR2);
+    uint32_t length = ((REG(base + ADC_SQR1) >> 20) & 0xFu) + 1u;
+    uint64_t t_ns = adc->regular_done_ns;
+    uint32_t value = convert(n, regular_channel(n, adc->sequence_index), t_ns);
+
+    /* DR not read yet: overrun, only detected with DMA or EOCS */
+    if ((REG(base + ADC_SR) & SR_EOC) && (cr2 & (CR2_DMA | CR2_EOCS))) {
+        REG(base + ADC_SR) |= SR_OVR;
+    }
+    REG(base + ADC_DR) = value;
+    REG(base + ADC_SR) |= SR_EOC;
+    conversions++;
+
+    if (is_master(n)) {
+        uint32_t ccr = REG(ADC_CCR);
+
+        REG(ADC_CDR) = value;
+        if (CCR_DMA(ccr) == 1u) {
+            dma_request(ADC_CDR, value);
+        } else if (CCR_DMA(ccr) == 2u) {
+            if (multi_half) {
+                dma_request(ADC_CDR, multi_low | (value << 16));
+            }
+            multi_low = value;
+            multi_half ^= 1u;
+        }
+        if (cr2 & CR2_CONT) {
+            adc->regular_done_ns = t_ns + adc->interval_ns;
+        } else {
+            adc->regular_active = 0;
+        }
+        return;
+    }
+
+    if (cr2 & CR2_DMA) {
+        dma_request(base + ADC_DR, value);
+        REG(base + ADC_SR) &= ~SR_EOC;
+    }
+
+    adc->sequence_index++;
+    if ((cr1 & CR1_SCAN) && adc->sequence_index < length) {
+        adc->regular_done_ns = t_ns
+            + conversion_ns(n, regular_channel(n, adc->sequence_index));
+    } else if (cr2 & CR2_CONT) {
+        adc->sequence_index = 0;
+        adc->regular_done_ns = t_ns + conversion_ns(n, regular_channel(n, 0));
+    } else {
+        adc->regular_active = 0;
+    }
+}
+
+static void start_injected(unsigned n, uint64_t t_ns)
+{
+    uint32_t jsqr = REG(ADC_BASE(n) + ADC_JSQR);
+    unsigned length = ((jsqr >> 20) & 0x3u) + 1u;
+    unsigned i;
+
+    adcs[n].injected_active = 1;
+    adcs[n].injected_done_ns = t_ns;
+    for (i = 4u - length; i < 4u; i++) {
+        adcs[n].injected_done_ns += conversion_ns(n, (jsqr >> (5u * i)) & 0x1Fu);
+    }
+    REG(ADC_BASE(n) + ADC_SR) |= SR_JSTRT;
+}
+
+static void complete_injected(unsigned n)
+{
+    uint32_t base = ADC_BASE(n);
+    uint32_t jsqr = REG(base + ADC_JSQR);
+    unsigned length = ((jsqr >> 20) & 0x3u) + 1u;
+    unsigned i;
+
+    /* JSQ4 is converted last, a single conversion lands in JDR1 */
+    for (i = 0; i < length; i++) {
+        unsigned channel = (jsqr >> (5u * (4u - length + i))) & 0x1Fu;
+
+        REG(base + ADC_JDR1 + 4u * i) =
+            convert(n, channel, adcs[n].injected_done_ns);
+        conversions++;
+    }
+    adcs[n].injected_active = 0;
+    REG(base + ADC_SR) |= SR_JEOC;
+}
+
+static unsigned regular_channel(unsigned n, unsigned index)
+{
+    static const uint8_t sqr[3] = { ADC_SQR3, ADC_SQR2, ADC_SQR1 };
+
+    return (REG(ADC_BASE(n) + sqr[index / 6u]) >> (5u * (index % 6u))) & 0x1Fu;
+}
+
+static uint64_t conversion_ns(unsigned n, unsigned channel)
+{
+    uint32_t base = ADC_BASE(n);
+    uint32_t smpr = (channel < 10u) ? REG(base + ADC_SMPR2)
+                                    : REG(base + ADC_SMPR1);
+    uint32_t bits = 12u - 2u * ((REG(base + ADC_CR1) >> 24) & 0x3u);
+    uint64_t cycles = sample_cycles[(smpr >> (3u * (channel % 10u))) & 0x7u]
+                      + bits;
+
+    return cycles * 1000000000u / adc_clock_hz();
+}
+
+/*
+ * APB2 / 2, 4, 6 or 8
+ */
+static uint32_t adc_clock_hz(void)
+{
+    return SIM_APB2_CLOCK_HZ / (2u * (CCR_ADCPRE(REG(ADC_CCR)) + 1u));
+}
+
+static uint64_t trigger_ns(uint64_t index)
+{
+    uint64_t ticks = (uint64_t)(TIM2_PSC + 1u) * (TIM2_ARR + 1u);
+
+    return tim_start_ns
+           + (index + 1u) * ticks * 1000000000u / SIM_CPU_CLOCK_HZ;
+}
+
+static int is_triggered(unsigned n)
+{
+    uint32_t cr2 = REG(ADC_BASE(n) + ADC_CR2);
+
+    return tim_running && CR2_EXTEN(cr2) != 0
+           && CR2_EXTSEL(cr2) == EXTSEL_TIM2_TRGO;
+}
+
+static int is_master(unsigned n)
+{
+    return n == 0 && CCR_MULTI(REG(ADC_CCR)) != 0;
+}
+
+static uint32_t convert(unsigned n, unsigned channel, uint64_t t_ns)
+{
+    uint32_t ccr = REG(ADC_CCR);
+    uint32_t bits = 12u - 2u * ((REG(ADC_BASE(n) + ADC_CR1) >> 24) & 0x3u);
+    double voltage = 0.0;
+    double code;
+
+    switch (channel) {
+    case CHANNEL_POT1:
+    case CHANNEL_PC0:
+        voltage = sim_wave_voltage(t_ns);
+        break;
+    case CHANNEL_VREFINT:
+        voltage = (ccr & CCR_TSVREFE) ? VREFINT_V : 0.0;
+        break;
+    case CHANNEL_TEMP_VBAT:
+        if (ccr & CCR_VBATE) {
+            voltage = VBAT_V / 4.0;
+        } else if (ccr & CCR_TSVREFE) {
+            voltage = TS_V25 + TS_SLOPE_V * (TEMPERATURE - 25.0);
+        }
+        break;
+    default:
+        break;
+    }
+
+    code = voltage / SIM_VDDA * 4095.0 + 0.5;
+    if (noise > 0.0) {
+        code += noise * gauss();
+    }
+    if (code < 0.0) {
+        code = 0.0;
+    } else if (code > 4095.0) {
+        code = 4095.0;
+    }
+    return (uint32_t)code >> (12u - bits);
+}
+
+/*
+ * One request of the peripheral at 'peripheral' to the enabled stream
+ * with this peripheral address.
+ */
+static void dma_request(uint32_t peripheral, uint32_t value)
+{
+    unsigned s;
+
+    for (s = 0; s < DMA_NR_OF_STREAMS; s++) {
+        uint32_t cr = REG(DMA_CR(s));
+        uint32_t ndtr = REG(DMA_NDTR(s)) & 0xFFFFu;
+        uint32_t size = 1u << DMA_CR_MSIZE(cr);
+        uintptr_t address;
+
+        if (!(cr & DMA_CR_EN) || REG(DMA_PAR(s)) != peripheral || ndtr == 0) {
+            continue;
+        }
+
+        address = REG(DMA_M0AR(s));
+        if (cr & DMA_CR_MINC) {
+            address += (uintptr_t)(dma_initial[s] - ndtr) * size;
+        }
+        if (size == 1u) {
+            *(volatile uint8_t *)address = (uint8_t)value;
+        } else if (size == 2u) {
+            *(volatile uint16_t *)address = (uint16_t)value;
+        } else {
+            *(volatile uint32_t *)address = value;
+        }
+
+        ndtr--;
+        if (ndtr == dma_initial[s] / 2u) {
+            REG(DMA_ISR(s)) |= DMA_HTIF << DMA_FLAG_SHIFT(s);
+        }
+        if (ndtr == 0) {
+            REG(DMA_ISR(s)) |= DMA_TCIF << DMA_FLAG_SHIFT(s);
+            if (cr & DMA_CR_CIRC) {
+                ndtr = dma_initial[s];
+            } else {
+                REG(DMA_CR(s)) = cr & ~DMA_CR_EN;
+            }
+        }
+        REG(DMA_NDTR(s)) = ndtr;
+        return;
+    }
+}
+
+/*
+ * Standard normal distribution, xorshift and Box-Muller. Called from
+ * signal handlers, so no rand().
+ */
+static double gauss(void)
+{
+    double u1;
+    double u2;
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    u1 = (random_state + 1.0) / 4294967297.0;
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    u2 = random_state / 4294967296.0;
+
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
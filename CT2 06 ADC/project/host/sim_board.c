@@ -0,0 +1,641 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Host register model of the CT board for the ADC lab.
+ * --
+ * -- The firmware in ../app is compiled for x86-64 Linux with main()
+ * -- renamed to firmware_main(). The peripheral address ranges are mapped
+ * -- at their STM32F429 addresses, so the register macros of the firmware
+ * -- work unchanged:
+ * --  - GPIO, RCC, TIM2, CT board, external SRAM: plain memory
+ * --  - ADC, DMA, DWT and NVIC pages: PROT_NONE, each access faults.
+ * --    The SIGSEGV handler advances the model, unprotects the page and
+ * --    single steps the instruction (trap flag). The SIGTRAP handler then
+ * --    applies the side effects of the access and protects the page again.
+ * --  - Interrupts (DMA2 stream 0, ADC) are taken after a trapped access
+ * --    of the main program and by a 1 kHz SIGALRM tick, which also presses
+ * --    the buttons. The tick catches up in 50 us slices, so DMA blocks
+ * --    are not lost to late ticks. A one-shot timer on the same signal
+ * --    fires at the end of a conversion with EOC interrupt.
+ * -- CYCCNT counts at 84 MHz in real time, so cycle counts include the
+ * -- trap overhead of the host and are not those of the target.
+ * --
+ * -- Usage: adc_host [options] waveform.wav|waveform.csv
+ * --   -r hz     sample rate of a CSV file (default 10000)
+ * --   -t s      run time in s (default: length of the waveform)
+ * --   -d hex    DIP switches S31..S0
+ * --   -x n      hex switch
+ * --   -b n@s    press button Tn at time s for 200 ms (up to 16 times)
+ * --   -n lsb    RMS noise added to each conversion in 12 bit LSB
+ * --   -i ms     minimal interval between two printed LCD updates
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "The register model single steps with the x86-64 trap flag on Linux"
+#endif
+
+#define _GNU_SOURCE
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+/* user includes */
+#include "sim.h"
+#include "reg_ctboard.h"
+#include "hal_ct_lcd.h"
+#include "hal_fmc.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define REG(address)            (*((volatile uint32_t *)(uintptr_t)(address)))
+
+#define DMA_PAGE                0x40026000u
+#define SCS_PAGE                0xE000E000u
+#define DWT_CYCCNT              0xE0001004u
+#define NVIC_ISER(n)            (SCS_PAGE + 0x100u + 4u * (n))
+#define NVIC_ICER(n)            (SCS_PAGE + 0x180u + 4u * (n))
+#define IRQ_ADC                 18u
+#define IRQ_DMA2_STREAM0        56u
+
+/* Factory calibration for VDDA = 3.3 V, see sim_adc.c for the voltages */
+#define VREFINT_CAL_ADDRESS     0x1FFF7A2Au
+#define VREFINT_CAL             1502u       // 1.21 V
+#define TS_CAL1                 959u        // 0.7725 V at 30 deg C
+#define TS_CAL2                 1207u       // 0.9725 V at 110 deg C
+
+#define EFLAGS_TF               0x100
+#define PF_WRITE                0x2         // page fault error code
+#define TICK_US                 1000u
+#define SLICE_NS                50000u      // < half DMA buffer at 2.8 MS/s
+#define MAX_CATCH_UP_NS         10000000u
+#define BUTTON_PRESS_NS         200000000u
+#define MAX_PRESSES             16u
+#define LCD_SIZE                40u
+#define LCD_LINE                20u
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uintptr_t address;
+    size_t size;
+} region_t;
+
+typedef struct {
+    uint8_t button;
+    uint64_t t_ns;
+} press_t;
+
+typedef struct {
+    uint32_t irq;
+    void (*handler)(void);
+    int (*pending)(void);
+} vector_t;
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const region_t regions[] = {
+    { 0x1FFF7000u, 0x1000u },       // system memory, calibration words
+    { 0x40000000u, 0x30000u },      // APB1, APB2, AHB1
+    { 0x60000000u, 0x1000u },       // CT board
+    { 0x64000000u, 0x10000u },      // external SRAM, bank 2
+    { 0xE0000000u, 0x10000u }       // DWT, NVIC, SCB
+};
+static const uintptr_t trapped[] = {
+    SIM_ADC_PAGE, DMA_PAGE, SIM_DWT_PAGE, SCS_PAGE
+};
+
+static struct timespec start_time;
+static uint64_t end_ns;
+static uint64_t tick_ns;                    // model time of the last tick
+static uint64_t advance_limit_ns = UINT64_MAX;
+static timer_t event_timer;
+static uint32_t cyccnt_offset;
+static press_t presses[MAX_PRESSES];
+static unsigned nr_of_presses;
+
+/* Access in flight between SIGSEGV and SIGTRAP */
+static uintptr_t access_address;
+static int access_is_write;
+static int alarm_was_blocked;
+static uint32_t access_old;
+
+static char lcd[LCD_SIZE + 1];
+static char lcd_printed[LCD_SIZE + 1];
+static uint64_t lcd_interval_ns = 200000000u;
+static uint64_t lcd_printed_ns;
+
+void ADC_IRQHandler(void) __attribute__((weak));
+void DMA2_Stream0_IRQHandler(void) __attribute__((weak));
+int firmware_main(void);
+
+static int dma2_stream0_pending(void);
+static const vector_t vectors[] = {
+    { IRQ_ADC, ADC_IRQHandler, sim_adc_irq_pending },
+    { IRQ_DMA2_STREAM0, DMA2_Stream0_IRQHandler, dma2_stream0_pending }
+};
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void map_memory(void);
+static void protect(int prot);
+static uintptr_t trapped_page(uintptr_t address);
+static void on_segv(int sig, siginfo_t *info, void *context);
+static void on_trap(int sig, siginfo_t *info, void *context);
+static void on_tick(int sig);
+static void arm_event(uint64_t t_ns);
+static const vector_t *irq_pending(void);
+static void core_access(uintptr_t address, int is_write, int after);
+static void print_state(const char *prefix, int fd);
+static void finish(void);
+static void usage(const char *name);
+
+
+/* -- M A I N
+ * ------------------------------------------------------------------------- */
+
+int main(int argc, char *argv[])
+{
+    uint32_t csv_rate_hz = 10000;
+    uint32_t dip = 0;
+    uint8_t hex = 0;
+    double run_time_s = 0.0;
+    double noise_lsb = 0.0;
+    struct sigaction action;
+    struct itimerval tick;
+    struct sigevent event;
+    int option;
+
+    while ((option = getopt(argc, argv, "r:t:d:x:b:n:i:")) != -1) {
+        switch (option) {
+        case 'r':
+            csv_rate_hz = (uint32_t)strtoul(optarg, 0, 0);
+            break;
+        case 't':
+            run_time_s = strtod(optarg, 0);
+            break;
+        case 'd':
+            dip = (uint32_t)strtoul(optarg, 0, 16);
+            break;
+        case 'x':
+            hex = (uint8_t)strtoul(optarg, 0, 0);
+            break;
+        case 'b':
+            if (nr_of_presses < MAX_PRESSES) {
+                char *at;
+
+                presses[nr_of_presses].button =
+                    (uint8_t)strtoul(optarg, &at, 0);
+                presses[nr_of_presses].t_ns = (*at == '@')
+                    ? (uint64_t)(strtod(at + 1, 0) * 1e9) : 0;
+                nr_of_presses++;
+            }
+            break;
+        case 'n':
+            noise_lsb = strtod(optarg, 0);
+            break;
+        case 'i':
+            lcd_interval_ns = (uint64_t)(strtod(optarg, 0) * 1e6);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1 || csv_rate_hz == 0) {
+        usage(argv[0]);
+    }
+    if (sim_wave_load(argv[optind], csv_rate_hz) != 0) {
+        return EXIT_FAILURE;
+    }
+    end_ns = (run_time_s > 0.0) ? (uint64_t)(run_time_s * 1e9)
+                                : sim_wave_duration_ns();
+
+    map_memory();
+    *(volatile uint16_t *)(uintptr_t)(VREFINT_CAL_ADDRESS) = VREFINT_CAL;
+    *(volatile uint16_t *)(uintptr_t)(VREFINT_CAL_ADDRESS + 2u) = TS_CAL1;
+    *(volatile uint16_t *)(uintptr_t)(VREFINT_CAL_ADDRESS + 4u) = TS_CAL2;
+    CT_DIPSW->WORD = dip;
+    CT_HEXSW = hex;
+    memset(lcd, ' ', LCD_SIZE);
+    memcpy(lcd_printed, lcd, sizeof(lcd));
+    sim_adc_reset(noise_lsb);
+
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    sigaddset(&action.sa_mask, SIGALRM);
+    action.sa_flags = SA_SIGINFO;
+    action.sa_sigaction = on_segv;
+    sigaction(SIGSEGV, &action, 0);
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;     // ISRs from on_trap()
+    action.sa_sigaction = on_trap;
+    sigaction(SIGTRAP, &action, 0);
+    action.sa_flags = 0;
+    action.sa_handler = on_tick;
+    sigaction(SIGALRM, &action, 0);
+
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGALRM;
+    timer_create(CLOCK_MONOTONIC, &event, &event_timer);
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    protect(PROT_NONE);
+    tick.it_interval.tv_sec = 0;
+    tick.it_interval.tv_usec = TICK_US;
+    tick.it_value = tick.it_interval;
+    setitimer(ITIMER_REAL, &tick, 0);
+
+    return firmware_main();
+}
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+uint64_t sim_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - start_time.tv_sec) * 1000000000u
+           + (uint64_t)now.tv_nsec - (uint64_t)start_time.tv_nsec;
+}
+
+
+/*
+ *  See header file
+ */
+void hal_ct_lcd_write(uint8_t position, char text[])
+{
+    uint64_t now_ns = sim_now_ns();
+
+    while (position < LCD_SIZE && *text != '\0') {
+        lcd[position++] = *text++;
+    }
+    if (now_ns - lcd_printed_ns >= lcd_interval_ns
+            && memcmp(lcd, lcd_printed, LCD_SIZE) != 0) {
+        print_state("", STDOUT_FILENO);
+        memcpy(lcd_printed, lcd, LCD_SIZE);
+        lcd_printed_ns = now_ns;
+    }
+}
+
+
+/*
+ *  See header file
+ */
+void hal_ct_lcd_clear(void)
+{
+    memset(lcd, ' ', LCD_SIZE);
+}
+
+
+/*
+ *  See header file
+ */
+void hal_ct_lcd_color(hal_ct_lcd_color_t color, uint16_t value)
+{
+    (void)color;
+    (void)value;
+}
+
+
+/*
+ *  See header file
+ */
+void hal_fmc_init_sram(hal_fmc_sram_bank_t bank, hal_fmc_sram_init_t init,
+                       hal_fmc_sram_timing_t timing)
+{
+    (void)bank;
+    (void)init;
+    (void)timing;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static void map_memory(void)
+{
+    unsigned i;
+
+    for (i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        void *mapped = mmap((void *)regions[i].address, regions[i].size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                            -1, 0);
+
+        if (mapped != (void *)regions[i].address) {
+            fprintf(stderr, "cannot map 0x%08lx\n",
+                    (unsigned long)regions[i].address);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void protect(int prot)
+{
+    unsigned i;
+
+    for (i = 0; i < sizeof(trapped) / sizeof(trapped[0]); i++) {
+        mprotect((void *)trapped[i], SIM_PAGE_SIZE, prot);
+    }
+}
+
+/*
+ * Start of the trapped page containing 'address', 0 if not trapped
+ */
+static uintptr_t trapped_page(uintptr_t address)
+{
+    unsigned i;
+
+    for (i = 0; i < sizeof(trapped) / sizeof(trapped[0]); i++) {
+        if (address - trapped[i] < SIM_PAGE_SIZE) {
+            return trapped[i];
+        }
+    }
+    return 0;
+}
+
+/*
+ * Access to a trapped page: model before the access, then single step.
+ * SIGALRM stays blocked until the access is complete.
+ */
+static void on_segv(int sig, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = context;
+    uintptr_t address = (uintptr_t)info->si_addr;
+    uintptr_t page = trapped_page(address);
+
+    if (page == 0) {
+        static const char message[] = "segmentation fault\n";
+
+        write(STDERR_FILENO, message, sizeof(message) - 1u);
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    access_address = address;
+    access_is_write = (uc->uc_mcontext.gregs[REG_ERR] & PF_WRITE) != 0;
+    if (page == SIM_DWT_PAGE || page == SCS_PAGE) {
+        mprotect((void *)page, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+        core_access(address, access_is_write, 0);
+    } else {
+        /* The model accesses both pages */
+        mprotect((void *)SIM_ADC_PAGE, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+        mprotect((void *)DMA_PAGE, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+        uint64_t now_ns = sim_now_ns();
+
+        sim_adc_advance(now_ns < advance_limit_ns ? now_ns : advance_limit_ns);
+        sim_adc_access((uint32_t)address, access_is_write, 0);
+    }
+
+    alarm_was_blocked = sigismember(&uc->uc_sigmask, SIGALRM);
+    sigaddset(&uc->uc_sigmask, SIGALRM);
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+/*
+ * Access complete: side effects, protect again and take pending
+ * interrupts if the main program was interrupted. The ISRs run here with
+ * SIGALRM blocked, their own accesses nest.
+ */
+static void on_trap(int sig, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = context;
+    uintptr_t page;
+    const vector_t *vector = 0;
+    int thread_mode = !alarm_was_blocked;
+
+    (void)sig;
+    (void)info;
+    if (!(uc->uc_mcontext.gregs[REG_EFL] & EFLAGS_TF)) {
+        return;
+    }
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+
+    page = trapped_page(access_address);
+    if (page == SIM_DWT_PAGE || page == SCS_PAGE) {
+        core_access(access_address, access_is_write, 1);
+        mprotect((void *)page, SIM_PAGE_SIZE, PROT_NONE);
+    } else {
+        sim_adc_access((uint32_t)access_address, access_is_write, 1);
+        arm_event(sim_adc_next_irq_ns());
+        if (thread_mode) {
+            mprotect((void *)SCS_PAGE, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+            vector = irq_pending();
+            mprotect((void *)SCS_PAGE, SIM_PAGE_SIZE, PROT_NONE);
+        }
+        mprotect((void *)SIM_ADC_PAGE, SIM_PAGE_SIZE, PROT_NONE);
+        mprotect((void *)DMA_PAGE, SIM_PAGE_SIZE, PROT_NONE);
+    }
+
+    while (vector != 0) {
+        vector->handler();
+        protect(PROT_READ | PROT_WRITE);
+        vector = irq_pending();
+        protect(PROT_NONE);
+    }
+    if (thread_mode) {
+        sigdelset(&uc->uc_sigmask, SIGALRM);
+    }
+}
+
+/*
+ * 1 kHz: model time, buttons and the DMA interrupt. The model catches up
+ * in slices with the IRQ in between, so no DMA block is lost when the tick
+ * comes late. Traps in the ISR do not advance beyond the current slice.
+ */
+static void on_tick(int sig)
+{
+    uint64_t now_ns = sim_now_ns();
+    uint64_t slice_ns;
+    const vector_t *vector;
+    uint8_t buttons = 0;
+    unsigned i;
+
+    (void)sig;
+    if (now_ns - tick_ns > MAX_CATCH_UP_NS) {
+        tick_ns = now_ns - MAX_CATCH_UP_NS;     // overloaded, blocks get lost
+    }
+    protect(PROT_READ | PROT_WRITE);
+    for (slice_ns = tick_ns; slice_ns < now_ns; ) {
+        slice_ns += SLICE_NS;
+        if (slice_ns > now_ns) {
+            slice_ns = now_ns;
+        }
+        advance_limit_ns = slice_ns;
+        sim_adc_advance(slice_ns);
+        while ((vector = irq_pending()) != 0) {
+            protect(PROT_NONE);
+            vector->handler();
+            protect(PROT_READ | PROT_WRITE);
+        }
+    }
+    protect(PROT_NONE);
+    advance_limit_ns = UINT64_MAX;
+    tick_ns = now_ns;
+
+    for (i = 0; i < nr_of_presses; i++) {
+        if (now_ns >= presses[i].t_ns
+                && now_ns < presses[i].t_ns + BUTTON_PRESS_NS) {
+            buttons |= (uint8_t)(1u << presses[i].button);
+        }
+    }
+    CT_BUTTON = buttons;
+
+    if (now_ns >= end_ns) {
+        finish();
+    }
+}
+
+/*
+ * SIGALRM at model time 't_ns' in addition to the tick
+ */
+static void arm_event(uint64_t t_ns)
+{
+    struct itimerspec at;
+
+    if (t_ns == UINT64_MAX) {
+        return;
+    }
+    memset(&at, 0, sizeof(at));
+    t_ns += (uint64_t)start_time.tv_nsec;
+    at.it_value.tv_sec = start_time.tv_sec + (time_t)(t_ns / 1000000000u);
+    at.it_value.tv_nsec = (long)(t_ns % 1000000000u);
+    timer_settime(event_timer, TIMER_ABSTIME, &at, 0);
+}
+
+/*
+ * First interrupt enabled in the NVIC with its flag set, to be called
+ * with the pages unprotected
+ */
+static const vector_t *irq_pending(void)
+{
+    unsigned i;
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        const vector_t *vector = &vectors[i];
+
+        if (vector->handler != 0
+                && (REG(NVIC_ISER(vector->irq / 32u))
+                    & (1u << (vector->irq % 32u))) != 0
+                && vector->pending()) {
+            return vector;
+        }
+    }
+    return 0;
+}
+
+static int dma2_stream0_pending(void)
+{
+    return sim_dma_irq_pending(0);
+}
+
+/*
+ * DWT cycle counter and NVIC enable registers
+ */
+static void core_access(uintptr_t address, int is_write, int after)
+{
+    uint32_t reg = (uint32_t)address & ~0x3u;
+    uint32_t cycles = (uint32_t)(sim_now_ns() * (SIM_CPU_CLOCK_HZ / 1000000u)
+                                 / 1000u);
+    unsigned n;
+
+    if (reg == DWT_CYCCNT) {
+        if (!after) {
+            REG(reg) = cycles - cyccnt_offset;
+        } else if (is_write) {
+            cyccnt_offset = cycles - REG(reg);
+        }
+        return;
+    }
+
+    for (n = 0; n < 8u; n++) {
+        if (reg == NVIC_ISER(n) || reg == NVIC_ICER(n)) {
+            if (!after) {
+                access_old = REG(NVIC_ISER(n));
+                REG(NVIC_ICER(n)) = access_old;
+            } else if (is_write && reg == NVIC_ISER(n)) {
+                REG(NVIC_ISER(n)) |= access_old;
+            } else if (is_write) {
+                REG(NVIC_ISER(n)) = access_old & ~REG(reg);
+                REG(NVIC_ICER(n)) = REG(NVIC_ISER(n));
+            }
+        }
+    }
+}
+
+/*
+ * LCD, LEDs and 7-segment display in one line. snprintf() and write()
+ * only, the final state is printed from the tick handler.
+ */
+static void print_state(const char *prefix, int fd)
+{
+    char line[160];
+    uint64_t now_ns = sim_now_ns();
+    int length;
+
+    length = snprintf(line, sizeof(line),
+                      "%s%4u.%03u s |%.20s|%.20s| LED %08x SEG %04x\n",
+                      prefix, (unsigned)(now_ns / 1000000000u),
+                      (unsigned)(now_ns / 1000000u % 1000u),
+                      lcd, lcd + LCD_LINE, (unsigned)CT_LED->WORD,
+                      (unsigned)CT_SEG7->BIN.HWORD);
+    if (length > 0) {
+        write(fd, line, (size_t)length);
+    }
+}
+
+static void finish(void)
+{
+    char line[80];
+    int length;
+
+    print_state("end ", STDOUT_FILENO);
+    length = snprintf(line, sizeof(line), "%llu conversions\n",
+                      (unsigned long long)sim_adc_conversions());
+    if (length > 0) {
+        write(STDOUT_FILENO, line, (size_t)length);
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-r csv_rate_hz] [-t seconds] [-d dip_hex] "
+            "[-x hexsw] [-b button@s] [-n noise_lsb] [-i lcd_ms] "
+            "waveform.wav|waveform.csv|sine:<Hz>[:<V peak>]\n", name);
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,245 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  WAV/CSV waveform playback for the host register model.
+ * --
+ * -- WAV: PCM with 8 or 16 bit, first channel, full scale = 0 .. 3.3 V.
+ * -- CSV: one voltage per line, lines starting with '#' are ignored.
+ * -- sine:<Hz>[:<V peak>]: exact sine around VDDA / 2, 1 V peak by default.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* user includes */
+#include "sim.h"
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static float *samples = 0;
+static uint32_t nr_of_samples = 0;
+static uint32_t sample_rate_hz = 1;
+static double sine_hz = 0.0;
+static double sine_peak_v = 1.0;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static int load_wav(FILE *file);
+static int load_csv(FILE *file);
+static int append(double voltage);
+static uint32_t read_le(const uint8_t *bytes, unsigned size);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ *  See header file
+ */
+int sim_wave_load(const char *path, uint32_t csv_rate_hz)
+{
+    FILE *file;
+    const char *extension = strrchr(path, '.');
+    char *end;
+    int result;
+
+    // synthetic input, no file
+    if (strncmp(path, "sine:", 5) == 0) {
+        sine_hz = strtod(path + 5, &end);
+        if (*end == ':') {
+            sine_peak_v = strtod(end + 1, &end);
+        }
+        if (*end != '\0' || sine_hz <= 0.0) {
+            fprintf(stderr, "%s: expected sine:<Hz>[:<V peak>]\n", path);
+            return -1;
+        }
+        return 0;
+    }
+
+    file = fopen(path, "rb");
+    if (file == 0) {
+        perror(path);
+        return -1;
+    }
+    if (extension != 0 && strcmp(extension, ".wav") == 0) {
+        result = load_wav(file);
+    } else {
+        sample_rate_hz = csv_rate_hz;
+        result = load_csv(file);
+    }
+    fclose(file);
+
+    if (result == 0 && nr_of_samples == 0) {
+        fprintf(stderr, "%s: no samples\n", path);
+        result = -1;
+    }
+    return result;
+}
+
+
+/*
+ *  See header file
+ */
+double sim_wave_voltage(uint64_t t_ns)
+{
+    uint64_t index = t_ns * sample_rate_hz / 1000000000u;
+
+    if (sine_hz > 0.0) {
+        return SIM_VDDA / 2.0
+               + sine_peak_v * sin(2.0 * M_PI * sine_hz * (double)t_ns * 1e-9);
+    }
+    if (nr_of_samples == 0) {
+        return SIM_VDDA / 2.0;
+    }
+    return samples[index % nr_of_samples];
+}
+
+
+/*
+ *  See header file
+ */
+uint64_t sim_wave_duration_ns(void)
+{
+    if (sine_hz > 0.0) {
+        return 1000000000u;     // endless, 1 s without -t
+    }
+    return (uint64_t)nr_of_samples * 1000000000u / sample_rate_hz;
+}
+
+
+/* -- Local function definitions
+ * ------------------------------------------------------------------------- */
+
+static int load_wav(FILE *file)
+{
+    uint8_t header[12];
+    uint8_t chunk[8];
+    uint8_t format[16];
+    unsigned channels = 0;
+    unsigned bits = 0;
+    uint32_t size;
+    uint32_t i;
+
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0
+            || memcmp(header + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "not a RIFF/WAVE file\n");
+        return -1;
+    }
+
+    while (fread(chunk, 1, 8, file) == 8) {
+        size = read_le(chunk + 4, 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (size < 16 || fread(format, 1, 16, file) != 16) {
+                return -1;
+            }
+            if (read_le(format, 2) != 1) {
+                fprintf(stderr, "only PCM WAV files are supported\n");
+                return -1;
+            }
+            channels = read_le(format + 2, 2);
+            sample_rate_hz = read_le(format + 4, 4);
+            bits = read_le(format + 14, 2);
+            fseek(file, (long)(size - 16 + (size & 1u)), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            unsigned frame = channels * bits / 8u;
+            uint8_t bytes[64];
+
+            if (frame == 0 || frame > sizeof(bytes)
+                    || (bits != 8 && bits != 16)) {
+                fprintf(stderr, "unsupported WAV format\n");
+                return -1;
+            }
+            for (i = 0; i < size / frame; i++) {
+                double value;
+
+                if (fread(bytes, 1, frame, file) != frame) {
+                    break;
+                }
+                if (bits == 8) {
+                    value = (bytes[0] - 128.0) / 128.0;
+                } else {
+                    value = (int16_t)read_le(bytes, 2) / 32768.0;
+                }
+                if (append(SIM_VDDA / 2.0 * (1.0 + value)) != 0) {
+                    return -1;
+                }
+            }
+            return 0;
+        } else {
+            fseek(file, (long)(size + (size & 1u)), SEEK_CUR);
+        }
+    }
+    fprintf(stderr, "WAV file without data chunk\n");
+    return -1;
+}
+
+static int load_csv(FILE *file)
+{
+    char line[128];
+    char *end;
+    double voltage;
+
+    while (fgets(line, sizeof(line), file) != 0) {
+        if (line[0] == '#') {
+            continue;
+        }
+        voltage = strtod(line, &end);
+        if (end == line) {
+            continue;
+        }
+        if (append(voltage) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int append(double voltage)
+{
+    static uint32_t capacity = 0;
+
+    if (nr_of_samples == capacity) {
+        float *grown;
+
+        capacity = (capacity == 0) ? 4096u : 2u * capacity;
+        grown = realloc(samples, capacity * sizeof(float));
+        if (grown == 0) {
+            fprintf(stderr, "out of memory\n");
+            return -1;
+        }
+        samples = grown;
+    }
+    if (voltage < 0.0) {
+        voltage = 0.0;
+    } else if (voltage > SIM_VDDA) {
+        voltage = SIM_VDDA;
+    }
+    samples[nr_of_samples++] = (float)voltage;
+    return 0;
+}
+
+static uint32_t read_le(const uint8_t *bytes, unsigned size)
+{
+    uint32_t value = 0;
+
+    while (size-- > 0) {
+        value = (value << 8) | bytes[size];
+    }
+    return value;
+}
@@ -0,0 +1,189 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Accuracy test of the frequency meter adc_freq.
+ * --
+ * -- The sine of the sine:<Hz>:<V peak> input of adc_host (around VDDA / 2)
+ * -- is quantized to 12 bit at FREQ_SAMPLE_RATE_HZ of main.c with +-2 LSB
+ * -- of uniform noise and fed to adc_freq_process() in DMA sized blocks.
+ * -- For 50 Hz .. 33 kHz and 1, 16 and 128 periods per result the worst
+ * -- relative error of frequency and period over NR_OF_RESULTS results is
+ * -- compared with the limit of the number of periods. The error counts
+ * -- beyond the resolution of the result (1 mHz, 1 ns), which both are
+ * -- truncated to. Below 10 samples per period the linear interpolation
+ * -- of the crossing is off by a part of a sample that depends on the
+ * -- sampling phase; there only FAST_MAX_ERROR_PPM applies unless the
+ * -- period is a whole number of samples. The exit code is 1 if an error
+ * -- exceeds its limit.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* user includes */
+#include "adc_freq.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PI                  3.14159265358979323846
+#define SAMPLE_RATE_HZ      100000u     // FREQ_SAMPLE_RATE_HZ of main.c
+#define HYSTERESIS_LSB      16u         // FREQ_HYSTERESIS of main.c
+#define VDDA                3.3
+#define PEAK_V              1.5
+#define NOISE_LSB           2.0         // uniform, +-
+#define BLOCK_LENGTH        256u
+#define NR_OF_RESULTS       4u          // after the first one
+#define MAX_SAMPLES         (30u * SAMPLE_RATE_HZ)
+#define FAST_HZ             (SAMPLE_RATE_HZ / 10u)
+#define FAST_MAX_ERROR_PPM  5000.0
+#define NR_OF_FREQUENCIES   (sizeof(frequency_hz) / sizeof(frequency_hz[0]))
+#define NR_OF_SETTINGS      (sizeof(setting) / sizeof(setting[0]))
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint16_t nr_of_periods;
+    double max_error_ppm;
+} setting_t;
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const double frequency_hz[] = {
+    50.0, 123.4, 997.0, 4321.0, 10000.0, 14000.0, 20000.0, 25000.0, 33000.0
+};
+static const setting_t setting[] = {
+    { 1, 1500.0 }, { 16, 150.0 }, { 128, 20.0 }
+};
+static uint32_t random_state = 2463534242u;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double worst_error_ppm(double f_hz, uint16_t nr_of_periods);
+static uint16_t sample(double f_hz, uint32_t index);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int errors = 0;
+    double error;
+    double limit;
+    uint32_t f;
+    uint32_t s;
+
+    printf("frequency [Hz]");
+    for (s = 0; s < NR_OF_SETTINGS; s++) {
+        printf("  n%-4u [ppm]", setting[s].nr_of_periods);
+    }
+    printf("\n");
+    for (f = 0; f < NR_OF_FREQUENCIES; f++) {
+        printf("%14.1f", frequency_hz[f]);
+        for (s = 0; s < NR_OF_SETTINGS; s++) {
+            error = worst_error_ppm(frequency_hz[f], setting[s].nr_of_periods);
+            limit = setting[s].max_error_ppm;
+            if (frequency_hz[f] > FAST_HZ
+                    && fmod(SAMPLE_RATE_HZ, frequency_hz[f]) != 0.0) {
+                limit = FAST_MAX_ERROR_PPM;
+            }
+            printf("  %11.1f%s", error, error > limit ? "!" : " ");
+            if (error > limit) {
+                errors = 1;
+            }
+        }
+        printf("\n");
+    }
+    printf("limits [ppm]  ");
+    for (s = 0; s < NR_OF_SETTINGS; s++) {
+        printf("  %11.1f ", setting[s].max_error_ppm);
+    }
+    printf("\nabove %u Hz  %11.1f ppm unless the period is a whole number"
+           " of samples\n", FAST_HZ, FAST_MAX_ERROR_PPM);
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Larger relative error of frequency and period over NR_OF_RESULTS
+ * results, the first result is skipped. 1e6 if a result is missing.
+ */
+static double worst_error_ppm(double f_hz, uint16_t nr_of_periods)
+{
+    static adc_freq_t meter;
+    adc_freq_config_t config;
+    adc_freq_result_t result;
+    uint16_t block[BLOCK_LENGTH];
+    uint32_t index = 0;
+    uint32_t results = 0;
+    double worst = 0.0;
+    double error;
+    uint16_t i;
+
+    config.sample_rate_hz = SAMPLE_RATE_HZ;
+    config.nr_of_periods = nr_of_periods;
+    config.hysteresis = HYSTERESIS_LSB;
+    config.bits = 12;
+    adc_freq_init(&meter, &config);
+    random_state = 2463534242u;
+
+    while (index < MAX_SAMPLES && results < NR_OF_RESULTS + 1u) {
+        for (i = 0; i < BLOCK_LENGTH; i++) {
+            block[i] = sample(f_hz, index++);
+        }
+        adc_freq_process(&meter, block, BLOCK_LENGTH);
+        if (!adc_freq_read(&meter, &result) || result.frequency_mhz == 0) {
+            continue;
+        }
+        if (results++ == 0) {
+            continue;
+        }
+        error = (fabs(result.frequency_mhz - 1000.0 * f_hz) - 1.0)
+                / (1000.0 * f_hz);
+        worst = fmax(worst, error);
+        error = (fabs(result.period_ns - 1e9 / f_hz) - 1.0) * f_hz / 1e9;
+        worst = fmax(worst, error);
+    }
+    return (results < NR_OF_RESULTS + 1u) ? 1e6 : worst * 1e6;
+}
+
+/*
+ * 12 bit conversion of the noisy sine at sample 'index', xorshift noise
+ * with a fixed seed so every run gives the same result
+ */
+static uint16_t sample(double f_hz, uint32_t index)
+{
+    double lsb_per_v = 4096.0 / VDDA;
+    double x;
+    long code;
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    x = 2048.0
+        + PEAK_V * lsb_per_v * sin(2.0 * PI * f_hz * index / SAMPLE_RATE_HZ)
+        + NOISE_LSB * (2.0 * random_state / 4294967296.0 - 1.0);
+    code = lround(x);
+    return (uint16_t)(code < 0 ? 0 : code > 4095 ? 4095 : code);
+}
@@ -0,0 +1,256 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  DTMF test of the Goertzel detector bank adc_goertzel.
+ * --
+ * -- The bank is set up like init_tones() of main.c. All 16 keys are sent
+ * -- in turn, each for TONE_MS followed by PAUSE_MS of silence, as 12 bit
+ * -- samples with +-NOISE_LSB of noise, and fed in DMA sized blocks. Each
+ * -- key must give exactly four events: its row and column tone appear,
+ * -- then both disappear, and the row and column present at the same time
+ * -- must decode to the key sent. The exit code is 1 otherwise.
+ * -- The same samples are then timed with the host clock, fastest of
+ * -- NR_OF_RUNS runs, and reported per sample and detector. The cycle
+ * -- counter of the bank reads 0 here, see cyc/S/d on the target.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/* user includes */
+#include "adc_goertzel.h"
+#include "sim.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PI                  3.14159265358979323846
+#define SAMPLE_RATE_HZ      8000u       // TONE_SAMPLE_RATE_HZ of main.c
+#define BLOCK_LENGTH        205u        // TONE_BLOCK_LENGTH of main.c
+#define THRESHOLD           100u        // TONE_THRESHOLD of main.c
+#define MIN_SHARE           20u         // TONE_MIN_SHARE of main.c
+#define NR_OF_ROWS          4u
+#define TONE_MS             80u
+#define PAUSE_MS            80u
+#define PEAK_LSB            600.0       // of each of the two tones
+#define NOISE_LSB           2.0         // uniform, +-
+#define DMA_BLOCK_LENGTH    256u
+#define NR_OF_KEYS          16u
+#define KEY_SAMPLES         ((TONE_MS + PAUSE_MS) * SAMPLE_RATE_HZ / 1000u)
+#define NR_OF_SAMPLES       (NR_OF_KEYS * KEY_SAMPLES)
+#define NR_OF_RUNS          20u
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static const uint16_t tone_frequency[ADC_GOERTZEL_MAX_DETECTORS] = {
+    697, 770, 852, 941, 1209, 1336, 1477, 1633
+};
+static const char tone_key[] = "123A456B789C*0#D";
+static adc_goertzel_t bank;
+static uint16_t samples[NR_OF_SAMPLES];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static void init_bank(void);
+static void make_samples(void);
+static int check_key(uint8_t key, const adc_goertzel_event_t *event,
+                     uint8_t nr_of_events);
+static double now_ns(void);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    adc_goertzel_event_t event[4];
+    uint8_t nr_of_events = 0;
+    int errors = 0;
+    double best = 0.0;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint32_t i;
+    uint8_t key;
+
+    // the bank reads CYCCNT, give it a plain page instead of the DWT
+    if (mmap((void *)SIM_DWT_PAGE, SIM_PAGE_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)
+            != (void *)SIM_DWT_PAGE) {
+        fprintf(stderr, "cannot map 0x%08lx\n", (unsigned long)SIM_DWT_PAGE);
+        return EXIT_FAILURE;
+    }
+
+    make_samples();
+    init_bank();
+    printf("key  events\n");
+    for (key = 0; key < NR_OF_KEYS; key++) {
+        nr_of_events = 0;
+        for (i = 0; i < KEY_SAMPLES; i += DMA_BLOCK_LENGTH) {
+            adc_goertzel_process(&bank, &samples[key * KEY_SAMPLES + i],
+                                 (uint16_t)(KEY_SAMPLES - i < DMA_BLOCK_LENGTH
+                                            ? KEY_SAMPLES - i
+                                            : DMA_BLOCK_LENGTH));
+            while (nr_of_events < 4u
+                    && adc_goertzel_get_event(&bank, &event[nr_of_events])) {
+                nr_of_events++;
+            }
+        }
+        errors |= check_key(key, event, nr_of_events);
+    }
+    if (bank.lost != 0 || adc_goertzel_get_event(&bank, &event[0])) {
+        printf("events left over\n");
+        errors = 1;
+    }
+
+    for (run = 0; run < NR_OF_RUNS; run++) {
+        init_bank();
+        start = now_ns();
+        for (i = 0; i < NR_OF_SAMPLES; i += DMA_BLOCK_LENGTH) {
+            adc_goertzel_process(&bank, &samples[i],
+                                 (uint16_t)(NR_OF_SAMPLES - i
+                                            < DMA_BLOCK_LENGTH
+                                            ? NR_OF_SAMPLES - i
+                                            : DMA_BLOCK_LENGTH));
+        }
+        elapsed = now_ns() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    printf("%u detectors, N = %u: %.2f ns per sample and detector\n",
+           ADC_GOERTZEL_MAX_DETECTORS, BLOCK_LENGTH,
+           best / NR_OF_SAMPLES / ADC_GOERTZEL_MAX_DETECTORS);
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Same configuration as init_tones() of main.c at 12 bit
+ */
+static void init_bank(void)
+{
+    adc_goertzel_config_t config;
+    uint8_t d;
+
+    config.sample_rate_hz = SAMPLE_RATE_HZ;
+    config.block_length = BLOCK_LENGTH;
+    config.bits = 12;
+    config.nr_of_detectors = ADC_GOERTZEL_MAX_DETECTORS;
+    for (d = 0; d < ADC_GOERTZEL_MAX_DETECTORS; d++) {
+        config.tone[d].frequency_hz = tone_frequency[d];
+        config.tone[d].threshold = THRESHOLD;
+        config.tone[d].min_share = MIN_SHARE;
+    }
+    (void)adc_goertzel_init(&bank, &config);
+}
+
+/*
+ * Keys 0 .. 15 of tone_key, row tone plus column tone, then silence
+ */
+static void make_samples(void)
+{
+    uint32_t random_state = 2463534242u;
+    double row_hz;
+    double column_hz;
+    double t;
+    double x;
+    uint32_t i;
+    uint8_t key;
+
+    for (key = 0; key < NR_OF_KEYS; key++) {
+        row_hz = tone_frequency[key / NR_OF_ROWS];
+        column_hz = tone_frequency[NR_OF_ROWS + key % NR_OF_ROWS];
+        for (i = 0; i < KEY_SAMPLES; i++) {
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 17;
+            random_state ^= random_state << 5;
+            t = (double)i / SAMPLE_RATE_HZ;
+            x = 2048.0 + NOISE_LSB * (2.0 * random_state / 4294967296.0 - 1.0);
+            if (i < TONE_MS * SAMPLE_RATE_HZ / 1000u) {
+                x += PEAK_LSB * (sin(2.0 * PI * row_hz * t)
+                                 + sin(2.0 * PI * column_hz * t));
+            }
+            samples[key * KEY_SAMPLES + i] = (uint16_t)lround(x);
+        }
+    }
+}
+
+/*
+ * The events of one key must be: row and column appear (either order),
+ * then both disappear. Prints them and the decoded key.
+ */
+static int check_key(uint8_t key, const adc_goertzel_event_t *event,
+                     uint8_t nr_of_events)
+{
+    uint8_t expected = (uint8_t)((1u << (key / NR_OF_ROWS))
+                                 | (1u << (NR_OF_ROWS + key % NR_OF_ROWS)));
+    uint8_t appeared = 0;
+    uint8_t disappeared = 0;
+    char decoded = '-';
+    uint8_t row = 0;
+    uint8_t column = 0;
+    uint8_t e;
+
+    printf("  %c ", tone_key[key]);
+    for (e = 0; e < nr_of_events; e++) {
+        printf(" %c%4u", event[e].present ? '+' : '-',
+               tone_frequency[event[e].detector]);
+        if (event[e].present && e < 2u) {
+            appeared |= (uint8_t)(1u << event[e].detector);
+        } else if (!event[e].present && e >= 2u) {
+            disappeared |= (uint8_t)(1u << event[e].detector);
+        }
+    }
+
+    // one row and one column present, as display_tone_event() decodes
+    if (appeared == expected) {
+        while (!(appeared & (1u << row))) {
+            row++;
+        }
+        while (!(appeared & (1u << (NR_OF_ROWS + column)))) {
+            column++;
+        }
+        decoded = tone_key[row * NR_OF_ROWS + column];
+    }
+    printf("  key %c\n", decoded);
+    if (nr_of_events != 4u || appeared != expected
+            || disappeared != expected || decoded != tone_key[key]) {
+        printf("  expected +%u +%u -%u -%u, key %c\n",
+               tone_frequency[key / NR_OF_ROWS],
+               tone_frequency[NR_OF_ROWS + key % NR_OF_ROWS],
+               tone_frequency[key / NR_OF_ROWS],
+               tone_frequency[NR_OF_ROWS + key % NR_OF_ROWS], tone_key[key]);
+        return 1;
+    }
+    return 0;
+}
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  Test of the two heap median adc_median against qsort.
+ * --
+ * -- For every window length from 1 to ADC_MEDIAN_MAX_LENGTH two inputs
+ * -- of 2 N + FILL_MARGIN samples run through adc_median_update(): random
+ * -- 12 bit samples, and a noisy level with spikes to 0 and 4095, which
+ * -- gives many equal samples. Every output up to N = ALL_UP_TO, and every
+ * -- N / CHECKS_PER_WINDOW-th above, is compared with the median of the
+ * -- samples so far (at most N) sorted by qsort, including the rounded
+ * -- down mean of the two middle samples while the window fills. The exit
+ * -- code is 1 if an output differs.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* user includes */
+#include "adc_median.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define FILL_MARGIN         16u
+#define ALL_UP_TO           64u
+#define CHECKS_PER_WINDOW   16u
+#define LEVEL_LSB           2000u
+#define NOISE_LSB           3u          // uniform, +-
+#define SPIKE_PERCENT       10u
+#define LCG_NEXT(x)         ((x) * 1664525u + 1013904223u)
+
+
+/* -- Type definitions
+ * ------------------------------------------------------------------------- */
+
+typedef uint16_t (*input_t)(uint32_t *x);
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static adc_median_t median;
+static uint16_t window[ADC_MEDIAN_MAX_LENGTH];
+static uint16_t sorted[ADC_MEDIAN_MAX_LENGTH];
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static uint32_t check_input(const char *name, input_t input);
+static uint16_t sorted_median(uint16_t count);
+static int compare(const void *a, const void *b);
+static uint16_t random_input(uint32_t *x);
+static uint16_t spiky_input(uint32_t *x);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    uint32_t mismatches;
+
+    mismatches = check_input("random", random_input);
+    mismatches += check_input("spiky", spiky_input);
+    return mismatches != 0;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Runs 'input' through all window lengths, prints the number of compared
+ * outputs and the first mismatch, returns the number of mismatches
+ */
+static uint32_t check_input(const char *name, input_t input)
+{
+    uint32_t x = 12345u;
+    uint32_t checked = 0;
+    uint32_t mismatches = 0;
+    uint32_t step;
+    uint32_t i;
+    uint16_t length;
+    uint16_t oldest;
+    uint16_t count;
+    uint16_t sample;
+    uint16_t output;
+    uint16_t expected;
+
+    for (length = 1; length <= ADC_MEDIAN_MAX_LENGTH; length++) {
+        adc_median_init(&median, length);
+        step = (length <= ALL_UP_TO) ? 1u : length / CHECKS_PER_WINDOW;
+        oldest = 0;
+        count = 0;
+        for (i = 0; i < 2u * length + FILL_MARGIN; i++) {
+            sample = input(&x);
+            output = adc_median_update(&median, sample);
+            window[oldest] = sample;
+            oldest = (oldest + 1u == length) ? 0 : oldest + 1u;
+            if (count < length) {
+                count++;
+            }
+            if (i % step != 0) {
+                continue;
+            }
+            checked++;
+            expected = sorted_median(count);
+            if (output != expected) {
+                if (mismatches == 0) {
+                    printf("%s: N = %u, sample %u: %u instead of %u\n",
+                           name, length, i, output, expected);
+                }
+                mismatches++;
+            }
+        }
+    }
+    printf("%-7s N = 1 .. %u  %8u outputs  %u mismatches\n", name,
+           ADC_MEDIAN_MAX_LENGTH, checked, mismatches);
+    return mismatches;
+}
+
+/*
+ * Median of the first 'count' samples of the window sorted with qsort,
+ * for an even count the mean of the two middle samples rounded down
+ */
+static uint16_t sorted_median(uint16_t count)
+{
+    memcpy(sorted, window, count * sizeof(sorted[0]));
+    qsort(sorted, count, sizeof(sorted[0]), compare);
+    if (count & 0x1u) {
+        return sorted[count / 2u];
+    }
+    return (uint16_t)(((uint32_t)sorted[count / 2u - 1u]
+                       + sorted[count / 2u]) >> 1);
+}
+
+static int compare(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static uint16_t random_input(uint32_t *x)
+{
+    *x = LCG_NEXT(*x);
+    return (uint16_t)(*x >> 20);
+}
+
+/*
+ * Level of LEVEL_LSB +- NOISE_LSB, SPIKE_PERCENT of the samples are 0 or
+ * 4095
+ */
+static uint16_t spiky_input(uint32_t *x)
+{
+    *x = LCG_NEXT(*x);
+    if ((*x >> 16) % 100u < SPIKE_PERCENT) {
+        return (*x & 0x8000u) ? 4095u : 0u;
+    }
+    return (uint16_t)(LEVEL_LSB - NOISE_LSB
+                      + (*x >> 24) % (2u * NOISE_LSB + 1u));
+}
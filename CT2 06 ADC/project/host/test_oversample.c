@@ -0,0 +1,207 @@
+/* ----------------------------------------------------------------------------
+ * --  _____       ______  _____                                              -
+ * -- |_   _|     |  ____|/ ____|                                             -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems              -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of                       -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                           -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland               -
+ * ----------------------------------------------------------------------------
+ * --
+ * -- Description:  ENOB test of the oversample-and-decimate stage.
+ * --
+ * -- A sine at 90 % of full scale with Gaussian dither is quantized to
+ * -- 12 bit at the rate main.c uses and fed through adc_oversample_process()
+ * -- for 1 .. ADC_OVERSAMPLE_MAX_BITS extra bits. A sine with the known
+ * -- frequency is fitted to the output (amplitude, phase and offset), the
+ * -- residual gives ENOB = 12 - log2(sqrt(12) * rms error in 12 bit LSB).
+ * -- With 0.5 LSB of dither theory gives 11.0 bit without and 10.8 + n bit
+ * -- with n extra bits. The exit code is 1 if a level falls short of
+ * -- 10.5 + n bit.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------------- */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+/* user includes */
+#include "adc_filter.h"
+
+
+/* -- Macros
+ * ------------------------------------------------------------------------- */
+
+#define PI                  3.14159265358979323846
+#define SAMPLE_RATE_HZ      102400.0    // OVERSAMPLE_RATE_HZ of main.c
+#define SINE_HZ             13.37       // not a divisor of any output rate
+#define SINE_PEAK_LSB       1843.0      // 90 % of full scale
+#define MID_SCALE           2048.0
+#define DITHER_LSB          0.5         // RMS
+#define NR_OF_OUTPUTS       8192u       // per level
+#define MIN_ENOB(n)         (10.5 + (n))
+
+
+/* -- Module-wide variables
+ * ------------------------------------------------------------------------- */
+
+static uint32_t random_state = 2463534242u;
+
+
+/* -- Local function declarations
+ * ------------------------------------------------------------------------- */
+
+static double enob(uint8_t extra_bits);
+static uint16_t sample(uint32_t index);
+static double fit_residual(const double *t, const double *y, uint32_t n);
+static double gauss(void);
+
+
+/* Public function definitions
+ * ------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int errors = 0;
+    double result;
+    uint8_t n;
+
+    printf("extra bits  output bits  ENOB    min\n");
+    for (n = 0; n <= ADC_OVERSAMPLE_MAX_BITS; n++) {
+        result = enob(n);
+        printf("%10u  %11u  %5.2f  %5.2f%s\n", n, 12u + n, result,
+               MIN_ENOB(n), result < MIN_ENOB(n) ? "  FAIL" : "");
+        if (result < MIN_ENOB(n)) {
+            errors = 1;
+        }
+    }
+    return errors;
+}
+
+
+/* Local function definitions
+ * ------------------------------------------------------------------------- */
+
+/*
+ * ENOB with 'extra_bits' extra bits, 0: the 12 bit samples themselves.
+ * An output stands for the middle of the 4^n samples it sums up.
+ */
+static double enob(uint8_t extra_bits)
+{
+    static double t[NR_OF_OUTPUTS];
+    static double y[NR_OF_OUTPUTS];
+    adc_oversample_t oversample;
+    uint32_t per_output = 1u << (2u * extra_bits);
+    uint32_t index = 0;
+    uint32_t k = 0;
+    uint16_t output;
+
+    random_state = 2463534242u;
+    adc_oversample_init(&oversample, extra_bits);
+    while (k < NR_OF_OUTPUTS) {
+        if (extra_bits == 0) {
+            output = sample(index);
+        } else if (!adc_oversample_process(&oversample, sample(index),
+                                           &output)) {
+            index++;
+            continue;
+        }
+        index++;
+        t[k] = (index - (per_output + 1u) / 2.0) / SAMPLE_RATE_HZ;
+        y[k] = output / (double)(1u << extra_bits);     // in 12 bit LSB
+        k++;
+    }
+    return 12.0 - log2(sqrt(12.0) * fit_residual(t, y, NR_OF_OUTPUTS));
+}
+
+/*
+ * 12 bit conversion of the dithered sine at sample 'index'
+ */
+static uint16_t sample(uint32_t index)
+{
+    double x = MID_SCALE
+               + SINE_PEAK_LSB * sin(2.0 * PI * SINE_HZ * index
+                                     / SAMPLE_RATE_HZ)
+               + DITHER_LSB * gauss();
+    long code = lround(x);
+
+    return (uint16_t)(code < 0 ? 0 : code > 4095 ? 4095 : code);
+}
+
+/*
+ * Least squares fit of y = a cos(w t) + b sin(w t) + c, returns the RMS
+ * of the residual. Normal equations solved with Cramer's rule.
+ */
+static double fit_residual(const double *t, const double *y, uint32_t n)
+{
+    double m[3][3] = {{0.0}};
+    double v[3] = {0.0};
+    double basis[3];
+    double p[3];
+    double det;
+    double d;
+    double e;
+    double squares = 0.0;
+    uint32_t i;
+    uint8_t r;
+    uint8_t c;
+    uint8_t col;
+
+    for (i = 0; i < n; i++) {
+        basis[0] = cos(2.0 * PI * SINE_HZ * t[i]);
+        basis[1] = sin(2.0 * PI * SINE_HZ * t[i]);
+        basis[2] = 1.0;
+        for (r = 0; r < 3; r++) {
+            v[r] += basis[r] * y[i];
+            for (c = 0; c < 3; c++) {
+                m[r][c] += basis[r] * basis[c];
+            }
+        }
+    }
+
+    det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+          - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+          + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    for (col = 0; col < 3; col++) {
+        double a[3][3];
+
+        for (r = 0; r < 3; r++) {
+            for (c = 0; c < 3; c++) {
+                a[r][c] = (c == col) ? v[r] : m[r][c];
+            }
+        }
+        d = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+            - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+            + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+        p[col] = d / det;
+    }
+
+    for (i = 0; i < n; i++) {
+        e = y[i] - p[0] * cos(2.0 * PI * SINE_HZ * t[i])
+            - p[1] * sin(2.0 * PI * SINE_HZ * t[i]) - p[2];
+        squares += e * e;
+    }
+    return sqrt(squares / n);
+}
+
+/*
+ * Standard normal distribution, xorshift and Box-Muller like the noise
+ * of sim_adc.c, with a fixed seed so every run gives the same result
+ */
+static double gauss(void)
+{
+    double u1;
+    double u2;
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    u1 = (random_state + 1.0) / 4294967297.0;
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    u2 = random_state / 4294967296.0;
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+}
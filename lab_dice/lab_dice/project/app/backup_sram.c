@@ -0,0 +1,63 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Implementation of module backup_sram
+ * --               Provides access to the 4 KByte battery backed
+ * --               SRAM which keeps its content over a reset.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* standard includes */
+#include <reg_stm32f4xx.h>
+#include <hal_rcc.h>
+#include <hal_pwr.h>
+
+/* user includes */
+#include "backup_sram.h"
+
+/* macros visible only inside of module */
+#define PERIPH_BKPSRAM_ENABLE (1u << 18u)   // RCC->AHB1ENR
+#define CRC32_POLYNOMIAL      0xEDB88320u   // 0x04C11DB7 reflected
+
+/* function definitions */
+
+/*
+ * see header file
+ */
+volatile uint32_t *backup_sram_init(void)
+{
+    hal_rcc_set_peripheral(PER_PWR, ENABLE);
+    hal_pwr_set_backup_access(ENABLE);
+    RCC->AHB1ENR |= PERIPH_BKPSRAM_ENABLE;
+
+    if (hal_pwr_set_backup_domain(ENABLE) != ENABLED) {
+        return 0;
+    }
+    return (volatile uint32_t *)BACKUP_SRAM_BASE;
+}
+
+/*
+ * see header file
+ */
+uint32_t backup_sram_crc32(const volatile uint32_t *data, uint32_t nr_of_words)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    uint32_t i;
+    uint8_t bit;
+
+    for (i = 0; i < nr_of_words; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 32; bit++) {
+            crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,45 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Interface of module backup_sram
+ * --               Provides access to the 4 KByte battery backed
+ * --               SRAM which keeps its content over a reset.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* re-definition guard */
+#ifndef _BACKUP_SRAM_H
+#define _BACKUP_SRAM_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* macros visible outside of module */
+#define BACKUP_SRAM_BASE  0x40024000
+#define BACKUP_SRAM_SIZE  0x1000
+
+/* function declarations */
+
+/*
+ * Enables the clocks of the power controller and of the backup SRAM,
+ * enables write access to the backup domain and switches on the backup
+ * regulator so that the content is retained on VBAT.
+ * Returns a pointer to the start of the backup SRAM or 0 if the backup
+ * regulator did not get ready.
+ */
+volatile uint32_t *backup_sram_init(void);
+
+/*
+ * Returns the CRC-32 (polynomial 0x04C11DB7, reflected) over the
+ * 'nr_of_words' words starting at 'data'.
+ */
+uint32_t backup_sram_crc32(const volatile uint32_t *data, uint32_t nr_of_words);
+#endif
@@ -0,0 +1,64 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Compile time configuration of the dice
+ * --               Selects the number of faces of the dice and derives
+ * --               all sizes of the modules from it. Every derived
+ * --               value is a constant expression, so divisions and
+ * --               array sizes are resolved by the compiler.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* re-definition guard */
+#ifndef _DICE_CONFIG_H
+#define _DICE_CONFIG_H
+
+/* macros visible outside of module */
+
+/*
+ * Number of faces of the dice. Can be overridden in the project settings
+ * (C/C++ -> Define: DICE_SIDES=20). Must be one of SUPPORTED_DICE.
+ */
+#ifndef DICE_SIDES
+#define DICE_SIDES 6
+#endif
+
+/* X-macro with all supported polyhedral dice */
+#define SUPPORTED_DICE(X) X(4) X(6) X(8) X(10) X(12) X(20) X(100)
+
+#define DICE_IS_SUPPORTED(SIDES) + ((DICE_SIDES) == (SIDES))
+typedef char dice_sides_is_supported[
+    (0 SUPPORTED_DICE(DICE_IS_SUPPORTED)) ? 1 : -1];
+
+#define NR_OF_DICE_VALUES DICE_SIDES
+
+/*
+ * The histogram of the sums is limited to 600 entries, this keeps the
+ * statistics within the 4 KByte of backup SRAM for every dice.
+ */
+#define MAX_SUM_ENTRIES   600
+#define MAX_NR_OF_DICE    ((MAX_SUM_ENTRIES / NR_OF_DICE_VALUES) < 100 ? \
+                           (MAX_SUM_ENTRIES / NR_OF_DICE_VALUES) : 100)
+#define MAX_DICE_SUM      (MAX_NR_OF_DICE * NR_OF_DICE_VALUES)
+
+/*
+ * LCD layout of the statistics per dice value: up to 6 slots on line 1.
+ * Dice with more values are shown in pages of LCD_NR_OF_SLOTS values.
+ */
+#define NR_OF_CHAR_PER_LINE 20u
+#define LCD_NR_OF_SLOTS   (NR_OF_DICE_VALUES < 6 ? NR_OF_DICE_VALUES : 6)
+#define LCD_SLOT_WIDTH    (NR_OF_CHAR_PER_LINE / LCD_NR_OF_SLOTS)
+#define LCD_SLOT_DIGITS   (LCD_SLOT_WIDTH > 3 ? 3 : LCD_SLOT_WIDTH - 1)
+#define LCD_SLOT_MAX      (LCD_SLOT_DIGITS == 3 ? 999 : \
+                           LCD_SLOT_DIGITS == 2 ? 99 : 9)
+#define LCD_NR_OF_PAGES   ((NR_OF_DICE_VALUES + LCD_NR_OF_SLOTS - 1) / \
+                           LCD_NR_OF_SLOTS)
+#endif
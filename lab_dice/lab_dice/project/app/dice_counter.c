@@ -29,7 +29,8 @@ static uint8_t dice_counter = 1;
  * regularly in a loop to allow generation of a pseudo random number
  */
 void dice_counter_increment(void){
-	dice_counter = dice_counter%NR_OF_DICE_VALUES +1;
+	// compare instead of modulo: no division for any dice size
+	dice_counter = (dice_counter >= NR_OF_DICE_VALUES) ? 1 : dice_counter + 1;
 }
 
 /*
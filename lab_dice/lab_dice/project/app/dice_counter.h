@@ -22,8 +22,8 @@
 /* standard includes */
 #include <stdint.h>
 
-/* macros */
-#define NR_OF_DICE_VALUES 6
+/* user includes */
+#include "dice_config.h"
 
 /* function declarations */
 
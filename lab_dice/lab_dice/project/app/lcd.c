@@ -20,36 +20,37 @@
 /* user includes */
 #include "lcd.h"
 #include "reg_ctboard.h"
+#include "dice_config.h"
 
 /* macros */
 #define LCD_ADDR_LINE1      0u
 #define LCD_ADDR_LINE2      20u
 
-#define NR_OF_CHAR_PER_LINE 20u
-
 #define LCD_CLEAR           "                    "
 
 /// STUDENTS: To be programmed
 /*
  * \brief  Writes 'value' to the indicated 'position' on the lcd
  * 
- * \param  slot_nr: A number between 1 and 6 indicating at which one of the 
- *         six available slots on the lcd the 'value' shall be printed. The 
- *         values at the other 5 slots remain unchanged.
+ * \param  slot_nr: A number between 1 and LCD_NR_OF_SLOTS indicating at which
+ *         one of the available slots on the lcd the 'value' shall be
+ *         printed. The values at the other slots remain unchanged.
  * 
  * \param  value: The value to be printed
  */
  #define MAX_BG_COLOR 65535
-void lcd_write_value(uint8_t slot_nr, uint8_t value){
-	char string[3];
-	// 1; 0 1 
-	// 2; 3 4
-	// (slot-1)*3
-	int pos1 = (slot_nr-1)*3;
-	int pos2 = pos1 + 1;
-	(void)snprintf(string,3,"%2i",value);
-	CT_LCD->ASCII[pos1] = string[0];
-	CT_LCD->ASCII[pos2] = string[1];
+void lcd_write_value(uint8_t slot_nr, uint16_t value){
+	char string[LCD_SLOT_DIGITS + 1];
+	int i;
+	// slot width and digits are constants of the dice configuration
+	int pos = (slot_nr-1)*LCD_SLOT_WIDTH;
+	if (value > LCD_SLOT_MAX) {
+		value = LCD_SLOT_MAX;	// saturate instead of cutting off digits
+	}
+	(void)snprintf(string,LCD_SLOT_DIGITS + 1,"%*i",LCD_SLOT_DIGITS,value);
+	for(i = 0;i < LCD_SLOT_DIGITS;i++){
+		CT_LCD->ASCII[pos + i] = string[i];
+	}
 }
 
 /*
@@ -57,10 +58,10 @@ void lcd_write_value(uint8_t slot_nr, uint8_t value){
  * 
  * \param  total_value: The value to be printed
  */
-void lcd_write_total(uint8_t total_value){
+void lcd_write_total(uint16_t total_value){
 	char string[NR_OF_CHAR_PER_LINE];
 	int i;
-	(void)snprintf(string,NR_OF_CHAR_PER_LINE,"total throws %4i",total_value);
+	(void)snprintf(string,NR_OF_CHAR_PER_LINE,"total throws %5i",total_value);
 	for(i = 0;i < NR_OF_CHAR_PER_LINE;i++){
 		CT_LCD->ASCII[LCD_ADDR_LINE2 + i] = string[i];
 	}
@@ -79,4 +80,31 @@ void hal_ct_lcd_clear(void){
 	CT_LCD->BG.GREEN = MAX_BG_COLOR;
 	CT_LCD->BG.BLUE = MAX_BG_COLOR;
 }
-/// END: To be programmed
\ No newline at end of file
+/// END: To be programmed
+
+/*
+ * \brief  Writes the goodness of fit of the multi dice sums on the lcd.
+ *
+ * \param  chi_square_x10: The chi-square statistic multiplied by 10
+ *
+ * \param  degrees_of_freedom: The degrees of freedom of the statistic
+ *
+ * \param  total_sums: The number of multi dice throws
+ */
+void lcd_write_fit(uint16_t chi_square_x10, uint16_t degrees_of_freedom,
+                   uint16_t total_sums){
+	// room for a degrees_of_freedom above 999, only 20 chars are shown
+	char string[NR_OF_CHAR_PER_LINE + 3];
+	int i;
+	(void)snprintf(string,sizeof(string),"chi2 %5i.%1i df %3i ",
+	               chi_square_x10 / 10, chi_square_x10 % 10,
+	               degrees_of_freedom);
+	for(i = 0;i < NR_OF_CHAR_PER_LINE;i++){
+		CT_LCD->ASCII[LCD_ADDR_LINE1 + i] = string[i];
+	}
+	(void)snprintf(string,sizeof(string),"total sums   %5i  ",
+	               total_sums);
+	for(i = 0;i < NR_OF_CHAR_PER_LINE;i++){
+		CT_LCD->ASCII[LCD_ADDR_LINE2 + i] = string[i];
+	}
+}
@@ -26,20 +26,34 @@
 /*
  * \brief  Writes 'value' to the indicated 'position' on the lcd
  * 
- * \param  slot_nr: A number between 1 and 6 indicating at which one of the 
- *         six available slots on the lcd the 'value' shall be printed. The 
- *         values at the other 5 slots remain unchanged.
+ * \param  slot_nr: A number between 1 and LCD_NR_OF_SLOTS indicating at which
+ *         one of the available slots on the lcd the 'value' shall be
+ *         printed. The values at the other slots remain unchanged.
  * 
  * \param  value: The value to be printed
  */
-void lcd_write_value(uint8_t slot_nr, uint8_t value);
+void lcd_write_value(uint8_t slot_nr, uint16_t value);
 
 /*
  * \brief  Writes an explanatory string followed by 'total_value' on the lcd. 
  * 
  * \param  total_value: The value to be printed
  */
-void lcd_write_total(uint8_t total_value);
+void lcd_write_total(uint16_t total_value);
+
+/*
+ * \brief  Writes the goodness of fit of the multi dice sums on the lcd.
+ *         Line 1 shows the chi-square statistic with one decimal place and
+ *         the degrees of freedom, line 2 the number of multi dice throws.
+ *
+ * \param  chi_square_x10: The chi-square statistic multiplied by 10
+ *
+ * \param  degrees_of_freedom: The degrees of freedom of the statistic
+ *
+ * \param  total_sums: The number of multi dice throws
+ */
+void lcd_write_fit(uint16_t chi_square_x10, uint16_t degrees_of_freedom,
+                   uint16_t total_sums);
 
 
 /*
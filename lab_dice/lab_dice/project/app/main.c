@@ -23,22 +23,44 @@
 #include "dice_counter.h"
 #include "lcd.h"
 
+/* macros */
+#define NR_OF_DICE_PER_THROW 2      // 1 .. MAX_NR_OF_DICE
+#define FIT_VIEW_MASK        0x01   // S0: show goodness of fit of the sums
+#define CHI_SQUARE_MAX       6553.5f  // larger values are shown as 6553.5
+
 /* function definitions */
 
 /*
  * Pushing button T0 displays a pseudo random dice value.
- * Throws are recorded and statistics are continuously displayed.
+ * Throws are recorded in the backup SRAM and statistics are continuously
+ * displayed. They survive a reset as long as VBAT is supplied.
+ * Every NR_OF_DICE_PER_THROW throws are summed up to one multi dice throw.
+ * With S0 on, the goodness of fit of the sums against their exact expected
+ * distribution is displayed instead of the single dice statistics.
+ * Dice with more than LCD_NR_OF_SLOTS values are displayed in pages, the
+ * page is selected with S15..S8.
  */
 
 int main(void)
 {
     uint8_t dice_number;
     uint8_t i;
-    uint8_t number_of_throws;
+    uint16_t number_of_throws;
     uint8_t previous_keys_value = 0x0;
     uint8_t key_pressed;
+    uint16_t dice_sum = 0;
+    uint8_t nr_of_dice_thrown = 0;
+    float chi_square;
+    uint16_t chi_square_x10 = 0;
+    uint16_t degrees_of_freedom = 0;
+    uint8_t fit_view;
+    uint8_t previous_fit_view = 0;
+    uint8_t page;
+    uint8_t previous_page = 0;
     
     hal_ct_lcd_clear();
+    (void)stat_set_nr_of_dice(NR_OF_DICE_PER_THROW);
+    (void)stat_use_backup_sram();
 
     while (1) {
         // roll the dice ...
@@ -49,17 +71,47 @@ int main(void)
             dice_number = dice_counter_read();
             hal_ct_seg7_bin_write(dice_number);
             stat_add_throw(dice_number);
+
+            dice_sum += dice_number;
+            nr_of_dice_thrown++;
+            if (nr_of_dice_thrown == NR_OF_DICE_PER_THROW) {
+                stat_add_sum(dice_sum);
+                // only re-evaluated per throw, not per loop iteration
+                chi_square = stat_chi_square(&degrees_of_freedom);
+                chi_square_x10 = (chi_square < CHI_SQUARE_MAX) ?
+                                 (uint16_t)(10.0f * chi_square) : 0xFFFF;
+                dice_sum = 0;
+                nr_of_dice_thrown = 0;
+            }
         }
 
         dice_counter_increment();
 
-        // display statistics: per number and total 
-        for (i = 1; i <= NR_OF_DICE_VALUES; i++) {
-            number_of_throws = stat_read(i);
-            if (number_of_throws != ERROR_VALUE) {
-                lcd_write_value(i, number_of_throws);
+        // all views share the lcd, start from a blank one on a change
+        fit_view = CT_DIPSW->BYTE.S7_0 & FIT_VIEW_MASK;
+        page = CT_DIPSW->BYTE.S15_8;
+        if (page >= LCD_NR_OF_PAGES) {
+            page = LCD_NR_OF_PAGES - 1;
+        }
+        if (fit_view != previous_fit_view || page != previous_page) {
+            hal_ct_lcd_clear();
+            previous_fit_view = fit_view;
+            previous_page = page;
+        }
+
+        if (fit_view) {
+            // display goodness of fit of the multi dice sums
+            lcd_write_fit(chi_square_x10, degrees_of_freedom,
+                          stat_read_sum(0));
+        } else {
+            // display statistics: per number of the page and total 
+            for (i = 1; i <= LCD_NR_OF_SLOTS; i++) {
+                number_of_throws = stat_read(page * LCD_NR_OF_SLOTS + i);
+                if (number_of_throws != ERROR_COUNT_VALUE) {
+                    lcd_write_value(i, number_of_throws);
+                }
             }
+            lcd_write_total(stat_read(0));
         }
-        lcd_write_total(stat_read(0));
     }
 }
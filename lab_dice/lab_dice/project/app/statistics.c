@@ -17,12 +17,58 @@
 
 /* user includes */
 #include "statistics.h"
+#include "backup_sram.h"
+
+/* macros visible only inside of module */
+#define MIN_EXPECTED_COUNT 5.0f
+
+#define STORE_MAGIC        0x53544154u     // "STAT"
+#define STORE_HEADER_WORDS 2u              // magic and layout
+#define LAYOUT(DICE)       (((uint32_t)MAX_DICE_SUM << 16) | \
+                            ((uint32_t)NR_OF_DICE_VALUES << 8) | (DICE))
+
+/*
+ * Each counter is kept in one word: the count in the lower half and its
+ * one's complement in the upper half. A throw thus costs two word writes
+ * and a corrupted counter is detected when it is read.
+ */
+#define CHECKED(COUNT)     ((uint32_t)(uint16_t)(COUNT) | \
+                            ((uint32_t)(uint16_t)~(COUNT) << 16))
+#define IS_VALID(WORD)     (((WORD) >> 16) == (~(WORD) & 0xFFFFu))
+#define COUNT(WORD)        ((uint16_t)(WORD))
+
+/* type definitions */
+typedef struct {
+    uint32_t magic;
+    uint32_t layout;
+    uint32_t header_crc;
+    // index 0:         total number of throws
+    // index 1 to 6:    number of throws for each digit
+    uint32_t nr_of_throws[NR_OF_DICE_VALUES + 1];
+    // index 0:                          total number of multi dice throws
+    // index nr_of_dice to 6*nr_of_dice: number of throws for each sum
+    uint32_t nr_of_sums[MAX_DICE_SUM + 1];
+} stat_store_t;
+
+typedef char stat_store_fits_backup_sram[
+    (sizeof(stat_store_t) <= BACKUP_SRAM_SIZE) ? 1 : -1];
 
 /* variables visible within the whole module*/
 
-// index 0:         total number of throws
-// index 1 to 6:    number of throws for each digit
-static uint8_t nr_of_throws[NR_OF_DICE_VALUES + 1];
+// statistics live in RAM until they are moved to the backup SRAM
+static stat_store_t ram_store;
+static volatile stat_store_t *store = &ram_store;
+
+// number of dice summed up per multi dice throw
+static uint8_t nr_of_dice = 1;
+
+// exact probability of each sum for the selected number of dice
+static float expected_probability[MAX_DICE_SUM + 1];
+
+/* local function declarations */
+static uint8_t store_is_valid(void);
+static void store_format(void);
+static void store_increment(volatile uint32_t *counter);
 
 /* function definitions */
 
@@ -36,24 +82,248 @@ static uint8_t nr_of_throws[NR_OF_DICE_VALUES + 1];
 void stat_add_throw(uint8_t throw_value){
 	// 1 <= throw_value <= NR_OF_DICE_VALUES
 	if (1 <= throw_value && throw_value <= NR_OF_DICE_VALUES){
+		if (store->magic != STORE_MAGIC) {
+			store_format();
+		}
 		// increment total nr of throws by one
-		nr_of_throws[0] += 1;
+		store_increment(&store->nr_of_throws[0]);
 		// increment the number for the throws with the result throw_value.
-		nr_of_throws[throw_value] += 1;
+		store_increment(&store->nr_of_throws[throw_value]);
 	}
 }
 
 /*
  * Return the number of throws with the result 'dice_number'
  * For 'dice_number' equal zero the total number of throws will be returned.
- * If 'dice_number' is above NR_OF_DICE_VALUES the error code ERROR_VALUE will
- * be returned.
+ * If 'dice_number' is above NR_OF_DICE_VALUES or its counter is corrupted
+ * the error code ERROR_COUNT_VALUE will be returned.
  */
-uint8_t stat_read(uint8_t dice_number){
+uint16_t stat_read(uint8_t dice_number){
 	if (0 <= dice_number && dice_number <= NR_OF_DICE_VALUES){
-		return nr_of_throws[dice_number];
+		if (store->magic != STORE_MAGIC) {
+			return 0;
+		}
+		if (!IS_VALID(store->nr_of_throws[dice_number])) {
+			return ERROR_COUNT_VALUE;
+		}
+		return COUNT(store->nr_of_throws[dice_number]);
 	} else {
-		return ERROR_VALUE;
+		return ERROR_COUNT_VALUE;
 	}
 }
-/// END: To be programmed
\ No newline at end of file
+/// END: To be programmed
+
+/*
+ * Distribution of the sum of n dice = distribution of n-1 dice convolved
+ * with the uniform distribution of a single dice. The new coefficient at
+ * index 'sum' only depends on lower indices, therefore the convolution is
+ * done in place from the highest sum downwards.
+ */
+uint8_t stat_set_nr_of_dice(uint8_t dice)
+{
+    uint16_t n;
+    uint16_t sum;
+    uint16_t min_old;
+    uint16_t max_old;
+    uint8_t k;
+    float acc;
+
+    if (dice < 1 || dice > MAX_NR_OF_DICE) {
+        return ERROR_VALUE;
+    }
+    nr_of_dice = dice;
+
+    // recorded statistics are only kept if they were taken with this setting
+    if (!store_is_valid()) {
+        store_format();
+    }
+
+    for (sum = 0; sum <= MAX_DICE_SUM; sum++) {
+        expected_probability[sum] = 0.0f;
+    }
+
+    // zero dice: the sum is 0 with probability 1
+    expected_probability[0] = 1.0f;
+
+    for (n = 1; n <= dice; n++) {
+        min_old = n - 1;
+        max_old = (n - 1) * NR_OF_DICE_VALUES;
+        for (sum = n * NR_OF_DICE_VALUES; sum >= n; sum--) {
+            acc = 0.0f;
+            for (k = 1; k <= NR_OF_DICE_VALUES; k++) {
+                if (sum - k >= min_old && sum - k <= max_old) {
+                    acc += expected_probability[sum - k];
+                }
+            }
+            expected_probability[sum] = acc * (1.0f / NR_OF_DICE_VALUES);
+        }
+        expected_probability[min_old] = 0.0f;
+    }
+    return nr_of_dice;
+}
+
+/*
+ * see header file
+ */
+void stat_add_sum(uint16_t sum_value)
+{
+    if (nr_of_dice <= sum_value
+            && sum_value <= nr_of_dice * NR_OF_DICE_VALUES) {
+        if (store->magic != STORE_MAGIC) {
+            store_format();
+        }
+        store_increment(&store->nr_of_sums[0]);
+        store_increment(&store->nr_of_sums[sum_value]);
+    }
+}
+
+/*
+ * see header file
+ */
+uint16_t stat_read_sum(uint16_t sum_value)
+{
+    if (sum_value == 0 || (nr_of_dice <= sum_value
+            && sum_value <= nr_of_dice * NR_OF_DICE_VALUES)) {
+        if (store->magic != STORE_MAGIC) {
+            return 0;
+        }
+        if (!IS_VALID(store->nr_of_sums[sum_value])) {
+            return ERROR_SUM_VALUE;
+        }
+        return COUNT(store->nr_of_sums[sum_value]);
+    } else {
+        return ERROR_SUM_VALUE;
+    }
+}
+
+/*
+ * see header file
+ */
+float stat_expected_probability(uint16_t sum_value)
+{
+    if (sum_value > MAX_DICE_SUM) {
+        return 0.0f;
+    }
+    return expected_probability[sum_value];
+}
+
+/*
+ * see header file
+ */
+float stat_chi_square(uint16_t *degrees_of_freedom)
+{
+    float total = 0.0f;
+    float valid_probability = 0.0f;
+    float chi_square = 0.0f;
+    float pooled_observed = 0.0f;
+    float pooled_expected = 0.0f;
+    float expected;
+    float diff;
+    uint16_t nr_of_classes = 0;
+    uint16_t observed;
+    uint16_t sum;
+
+    // corrupted counters are not counted, neither observed nor expected
+    for (sum = nr_of_dice; sum <= nr_of_dice * NR_OF_DICE_VALUES; sum++) {
+        observed = stat_read_sum(sum);
+        if (observed != ERROR_SUM_VALUE) {
+            total += (float)observed;
+            valid_probability += expected_probability[sum];
+        }
+    }
+    if (valid_probability > 0.0f) {
+        total /= valid_probability;
+    }
+
+    for (sum = nr_of_dice; sum <= nr_of_dice * NR_OF_DICE_VALUES; sum++) {
+        observed = stat_read_sum(sum);
+        if (observed == ERROR_SUM_VALUE) {
+            continue;
+        }
+        expected = expected_probability[sum] * total;
+        if (expected >= MIN_EXPECTED_COUNT) {
+            diff = (float)observed - expected;
+            chi_square += diff * diff / expected;
+            nr_of_classes++;
+        } else {
+            pooled_observed += (float)observed;
+            pooled_expected += expected;
+        }
+    }
+    if (pooled_expected > 0.0f) {
+        diff = pooled_observed - pooled_expected;
+        chi_square += diff * diff / pooled_expected;
+        nr_of_classes++;
+    }
+
+    *degrees_of_freedom = (nr_of_classes > 0) ? nr_of_classes - 1 : 0;
+    return chi_square;
+}
+
+/*
+ * see header file
+ */
+uint8_t stat_use_backup_sram(void)
+{
+    volatile uint32_t *backup = backup_sram_init();
+
+    if (backup == 0) {
+        return 0;
+    }
+    store = (volatile stat_store_t *)backup;
+
+    // only the header is checked, the counters are checked when read
+    if (store_is_valid()) {
+        return 1;
+    }
+    store_format();
+    return 0;
+}
+
+/* local function definitions */
+
+/*
+ * Returns 1 if the store holds statistics for the current layout.
+ * Only the fixed size header is checked --> constant time
+ */
+static uint8_t store_is_valid(void)
+{
+    return store->magic == STORE_MAGIC
+        && store->layout == LAYOUT(nr_of_dice)
+        && store->header_crc == backup_sram_crc32(&store->magic,
+                                                  STORE_HEADER_WORDS);
+}
+
+/*
+ * Clears all counters and writes the header for the current layout.
+ * The header CRC is written last so that an interrupted format is detected.
+ */
+static void store_format(void)
+{
+    uint16_t i;
+
+    store->magic = 0;
+    for (i = 0; i <= NR_OF_DICE_VALUES; i++) {
+        store->nr_of_throws[i] = CHECKED(0);
+    }
+    for (i = 0; i <= MAX_DICE_SUM; i++) {
+        store->nr_of_sums[i] = CHECKED(0);
+    }
+    store->layout = LAYOUT(nr_of_dice);
+    store->magic = STORE_MAGIC;
+    store->header_crc = backup_sram_crc32(&store->magic, STORE_HEADER_WORDS);
+}
+
+/*
+ * Increments a checked counter up to MAX_COUNT_VALUE, so that a count never
+ * reads as the error code. A corrupted counter restarts at 1.
+ */
+static void store_increment(volatile uint32_t *counter)
+{
+    uint32_t word = *counter;
+    uint16_t count = IS_VALID(word) ? COUNT(word) : 0;
+
+    if (count < MAX_COUNT_VALUE) {
+        *counter = CHECKED(count + 1);
+    }
+}
@@ -22,9 +22,14 @@
 /* standard includes */
 #include <stdint.h>
 
+/* user includes */
+#include "dice_config.h"
+
 /* macros visible outside of module */
-#define NR_OF_DICE_VALUES 6
 #define ERROR_VALUE       0xFF
+#define ERROR_SUM_VALUE   0xFFFF
+#define ERROR_COUNT_VALUE 0xFFFF
+#define MAX_COUNT_VALUE   0xFFFE          // counters stop here
 
 /* function declarations */
 
@@ -32,15 +37,76 @@
  * Increments the total number of throws as well as the number for the throws
  * with the result throw_value.
  * throw_value has to be in the range of 1 up to NR_OF_DICE_VALUES, otherwise
- * it will be ignored
+ * it will be ignored. The counts stop at MAX_COUNT_VALUE.
  */
 void stat_add_throw(uint8_t throw_value);
 
 /*
  * Return the number of throws with the result 'dice_number'
  * For 'dice_number' equal zero the total number of throws will be returned.
- * If 'dice_number' is above NR_OF_DICE_VALUES the error code ERROR_VALUE will
- * be returned.
+ * If 'dice_number' is above NR_OF_DICE_VALUES or its counter is corrupted
+ * the error code ERROR_COUNT_VALUE will be returned.
+ */
+uint16_t stat_read(uint8_t dice_number);
+
+/*
+ * Selects the number of dice 'dice' (1 up to MAX_NR_OF_DICE) that are
+ * summed up per throw. Recorded statistics are kept if they were taken
+ * with the same number of dice, otherwise all counters are cleared, the
+ * single dice counts of stat_read() as well as the histogram of sums.
+ * Computes the exact expected distribution of the sums
+ * dice .. NR_OF_DICE_VALUES * dice by repeated convolution with the
+ * distribution of a single dice. With V = NR_OF_DICE_VALUES die n costs
+ * V * ((V - 1) n + 1) additions, i.e. about V (V - 1) / 2 * dice^2 in
+ * total (152k for 100 six-sided dice), so it is meant to be called once
+ * at start-up and not per throw.
+ * Returns the selected number of dice or ERROR_VALUE if 'dice' is out
+ * of range, in which case the previous setting is kept.
+ */
+uint8_t stat_set_nr_of_dice(uint8_t dice);
+
+/*
+ * Increments the total number of multi dice throws as well as the number of
+ * throws with the sum 'sum_value'. This takes constant time. The counts
+ * stop at MAX_COUNT_VALUE.
+ * 'sum_value' has to be in the range nr_of_dice ..
+ * NR_OF_DICE_VALUES * nr_of_dice, otherwise it will be ignored.
+ */
+void stat_add_sum(uint16_t sum_value);
+
+/*
+ * Returns the number of throws with the sum 'sum_value'.
+ * For 'sum_value' equal zero the total number of multi dice throws will be
+ * returned. If 'sum_value' is outside nr_of_dice ..
+ * NR_OF_DICE_VALUES * nr_of_dice or its counter is corrupted the error
+ * code ERROR_SUM_VALUE will be returned.
+ */
+uint16_t stat_read_sum(uint16_t sum_value);
+
+/*
+ * Returns the exact probability of the sum 'sum_value' for the selected
+ * number of dice, 0 if 'sum_value' cannot be thrown.
+ */
+float stat_expected_probability(uint16_t sum_value);
+
+/*
+ * Returns Pearson's chi-square statistic of the recorded sums against the
+ * expected distribution. Sums with an expected count below 5 are pooled
+ * into one class. Sums whose counter is corrupted (ERROR_SUM_VALUE) are
+ * left out and the expected distribution is scaled to the remaining sums.
+ * The degrees of freedom (number of classes - 1) are written to
+ * 'degrees_of_freedom'.
+ */
+float stat_chi_square(uint16_t *degrees_of_freedom);
+
+/*
+ * Moves the statistics into the battery backed backup SRAM so that they
+ * survive a reset. Has to be called after stat_set_nr_of_dice().
+ * If the backup SRAM holds statistics recorded with the same number of dice
+ * they are restored, otherwise they are cleared. Only the CRC protected
+ * header is checked, so restoring takes constant time. Each counter is
+ * checked on its own when it is read.
+ * Returns 1 if statistics have been restored, 0 otherwise.
  */
-uint8_t stat_read(uint8_t dice_number);
+uint8_t stat_use_backup_sram(void);
 #endif
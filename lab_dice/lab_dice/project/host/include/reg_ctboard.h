@@ -0,0 +1,39 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Host replacement of the CT board registers
+ * --               Only the lcd used by lcd.c, as plain RAM.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* re-definition guard */
+#ifndef _REG_CTBOARD_H
+#define _REG_CTBOARD_H
+
+/* standard includes */
+#include <stdint.h>
+
+/* type definitions */
+typedef struct {
+    volatile uint8_t ASCII[40];
+    struct {
+        volatile uint16_t RED;
+        volatile uint16_t GREEN;
+        volatile uint16_t BLUE;
+    } BG;
+} reg_ct_lcd_t;
+
+/* variables visible outside of module */
+extern reg_ct_lcd_t sim_ct_lcd;
+
+/* macros visible outside of module */
+#define CT_LCD      (&sim_ct_lcd)
+#endif
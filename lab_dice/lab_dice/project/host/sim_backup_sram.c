@@ -0,0 +1,50 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Host replacement of module backup_sram
+ * --               The backup SRAM is a plain array, the CRC is the
+ * --               same bitwise CRC-32 as on the target.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* user includes */
+#include "backup_sram.h"
+
+/* variables visible within the whole module*/
+static uint32_t backup_sram[BACKUP_SRAM_SIZE / sizeof(uint32_t)];
+
+/* function definitions */
+
+/*
+ * see header file
+ */
+volatile uint32_t *backup_sram_init(void)
+{
+    return backup_sram;
+}
+
+/*
+ * see header file
+ */
+uint32_t backup_sram_crc32(const volatile uint32_t *data, uint32_t nr_of_words)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    uint32_t i;
+    uint8_t bit;
+
+    for (i = 0; i < nr_of_words; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 32; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+        }
+    }
+    return ~crc;
+}
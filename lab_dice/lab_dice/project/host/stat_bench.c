@@ -0,0 +1,241 @@
+/* ------------------------------------------------------------------
+ * --  _____       ______  _____                                    -
+ * -- |_   _|     |  ____|/ ____|                                   -
+ * --   | |  _ __ | |__  | (___    Institute of Embedded Systems    -
+ * --   | | | '_ \|  __|  \___ \   Zurich University of             -
+ * --  _| |_| | | | |____ ____) |  Applied Sciences                 -
+ * -- |_____|_| |_|______|_____/   8401 Winterthur, Switzerland     -
+ * ------------------------------------------------------------------
+ * --
+ * -- Description:  Host benchmark of module statistics
+ * --               For 1 up to MAX_NR_OF_DICE dice: time of
+ * --               stat_set_nr_of_dice() (the convolution), of
+ * --               stat_add_sum() and of stat_chi_square(). The
+ * --               computed distribution is checked against its sum
+ * --               and mean, the exit code is 1 if a check fails.
+ * --               The last line holds the cost of the per throw
+ * --               functions, which depend on the dice size only
+ * --               through constants (make compare).
+ * --               Times are host times, not target cycles.
+ * --
+ * -- $Id$
+ * ------------------------------------------------------------------
+ */
+
+/* standard includes */
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+/* user includes */
+#include "statistics.h"
+#include "dice_counter.h"
+#include "lcd.h"
+#include "reg_ctboard.h"
+
+/* macros */
+#define NR_OF_RUNS        9u        // the fastest run counts
+#define NR_OF_ADDS        1000000u
+#define NR_OF_CHI_SQUARES 1000u
+#define NR_OF_CALLS       1000000u
+#define TOLERANCE         1e-4
+
+/* local function declarations */
+static double now_ns(void);
+static double time_set_nr_of_dice(uint8_t dice);
+static uint32_t nr_of_additions(uint8_t dice);
+static uint8_t check_distribution(uint8_t dice);
+static double time_calls(void (*call)(uint32_t i));
+static void call_add_throw(uint32_t i);
+static void call_read(uint32_t i);
+static void call_counter(uint32_t i);
+static void call_lcd_value(uint32_t i);
+static void time_per_throw(void);
+
+/* variables visible within the whole module*/
+reg_ct_lcd_t sim_ct_lcd;
+
+/* function definitions */
+
+int main(void)
+{
+    static const uint8_t nr_of_dice[] = { 1, 2, 5, 10, 20, 50, 100 };
+    uint8_t errors = 0;
+    uint8_t dice;
+    uint32_t d;
+    uint32_t i;
+    uint16_t sum;
+    uint16_t degrees_of_freedom;
+    double start;
+    double add_ns;
+    double chi_ns;
+    double set_ns;
+
+    printf("d%u, up to %u dice\n", NR_OF_DICE_VALUES, MAX_NR_OF_DICE);
+    printf("dice  additions  set [us]  add [ns]  chi2 [us]\n");
+    for (d = 0; d < sizeof(nr_of_dice); d++) {
+        dice = nr_of_dice[d];
+        if (dice > MAX_NR_OF_DICE) {
+            break;
+        }
+        set_ns = time_set_nr_of_dice(dice);
+        errors |= check_distribution(dice);
+
+        sum = dice;
+        start = now_ns();
+        for (i = 0; i < NR_OF_ADDS; i++) {
+            stat_add_sum(sum);
+            sum = (sum < dice * NR_OF_DICE_VALUES) ? sum + 1 : dice;
+        }
+        add_ns = (now_ns() - start) / NR_OF_ADDS;
+
+        start = now_ns();
+        for (i = 0; i < NR_OF_CHI_SQUARES; i++) {
+            (void)stat_chi_square(&degrees_of_freedom);
+        }
+        chi_ns = (now_ns() - start) / NR_OF_CHI_SQUARES;
+
+        printf("%4u  %9u  %8.2f  %8.2f  %9.3f\n", dice,
+               nr_of_additions(dice), set_ns / 1000.0, add_ns,
+               chi_ns / 1000.0);
+    }
+    time_per_throw();
+    return errors;
+}
+
+/* local function definitions */
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * Fastest of NR_OF_RUNS calls. Switching between two settings makes
+ * every call reformat the store like a change on the target.
+ */
+static double time_set_nr_of_dice(uint8_t dice)
+{
+    double best = 0.0;
+    double start;
+    double elapsed;
+    uint32_t run;
+
+    for (run = 0; run < NR_OF_RUNS; run++) {
+        (void)stat_set_nr_of_dice(dice == 1 ? 2 : 1);
+        start = now_ns();
+        (void)stat_set_nr_of_dice(dice);
+        elapsed = now_ns() - start;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/*
+ * Die n convolves 5n + 1 sums with NR_OF_DICE_VALUES terms each
+ */
+static uint32_t nr_of_additions(uint8_t dice)
+{
+    uint32_t additions = 0;
+    uint32_t n;
+
+    for (n = 1; n <= dice; n++) {
+        additions += NR_OF_DICE_VALUES
+                     * ((NR_OF_DICE_VALUES - 1u) * n + 1u);
+    }
+    return additions;
+}
+
+/*
+ * The probabilities sum up to 1, the mean is dice * (sides + 1) / 2
+ */
+static uint8_t check_distribution(uint8_t dice)
+{
+    double total = 0.0;
+    double mean = 0.0;
+    double expected_mean = dice * (NR_OF_DICE_VALUES + 1) / 2.0;
+    uint16_t sum;
+
+    for (sum = 0; sum <= MAX_DICE_SUM; sum++) {
+        total += stat_expected_probability(sum);
+        mean += sum * (double)stat_expected_probability(sum);
+    }
+    if (fabs(total - 1.0) > TOLERANCE
+            || fabs(mean - expected_mean) > TOLERANCE * expected_mean) {
+        printf("%u dice: sum of probabilities %f, mean %f instead of %f\n",
+               dice, total, mean, expected_mean);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Average time per call of 'call' over NR_OF_CALLS calls, fastest of
+ * NR_OF_RUNS runs
+ */
+static double time_calls(void (*call)(uint32_t i))
+{
+    double best = 0.0;
+    double start;
+    double elapsed;
+    uint32_t run;
+    uint32_t i;
+
+    for (run = 0; run < NR_OF_RUNS; run++) {
+        start = now_ns();
+        for (i = 0; i < NR_OF_CALLS; i++) {
+            call(i);
+        }
+        elapsed = (now_ns() - start) / NR_OF_CALLS;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/* the callers wrap with a compare like dice_counter, no division */
+static void call_add_throw(uint32_t i)
+{
+    static uint8_t value = 1;
+
+    (void)i;
+    stat_add_throw(value);
+    value = (value >= NR_OF_DICE_VALUES) ? 1 : value + 1;
+}
+
+static void call_read(uint32_t i)
+{
+    (void)stat_read((uint8_t)(i & 0x7u));
+}
+
+static void call_counter(uint32_t i)
+{
+    (void)i;
+    dice_counter_increment();
+}
+
+static void call_lcd_value(uint32_t i)
+{
+    static uint8_t slot = 1;
+
+    lcd_write_value(slot, (uint8_t)i);
+    slot = (slot >= LCD_NR_OF_SLOTS) ? 1 : slot + 1;
+}
+
+/*
+ * The functions called for every throw
+ */
+static void time_per_throw(void)
+{
+    printf("per call [ns]  add_throw %.2f  read %.2f  counter %.2f"
+           "  lcd_value %.2f\n", time_calls(call_add_throw),
+           time_calls(call_read), time_calls(call_counter),
+           time_calls(call_lcd_value));
+}
@@ -11,6 +11,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <arm_acle.h>
 #include <reg_stm32f4xx.h>
 #include "hal_ct_lcd.h"
 #include "hal_timer.h"
@@ -27,6 +28,78 @@
 
 #define STRING_LENGTH_FOR_32BIT      11     // 4G --> 10 bit plus end of string
 
+/* DWT cycle counter, counts at HCLK = 84 MHz like TIM2 with prescaler 0 */
+#define DEMCR                        (*((volatile uint32_t *)(0xE000EDFC)))
+#define DEMCR_TRCENA                 (0x1u << 24)
+#define DWT_CTRL                     (*((volatile uint32_t *)(0xE0001000)))
+#define DWT_CTRL_CYCCNTENA           (0x1u << 0)
+#define DWT_CYCCNT                   (*((volatile uint32_t *)(0xE0001004)))
+
+#define TIM_CR1_DIR                  (0x1u << 4)
+/* APB1 = HCLK / 2, the timer clock is doubled back to 84 MHz */
+#define CYCLES_PER_TIM2_TICK         1u     // prescaler 0
+#define CALIBRATION_RUNS             16u
+
+/* twice the nominal 1 s, TIM2 may starve behind a 1000 kHz load */
+#define MEASUREMENT_TIMEOUT_CYCLES   (2u * NUMBER_OF_TIMER_2_INTERRUPTS \
+                                      * RELOAD_VALUE_TIM2)
+
+/* Log-linear histogram: values below 2^SUB_BITS exactly, above in octaves
+ * of 2^SUB_BITS buckets each, i.e. buckets at most 1/32 = 3.1 % wide. The
+ * last bucket collects everything from 2^(SUB_BITS + OCTAVES) = 2^25 on. */
+#define HISTOGRAM_SUB_BITS           5u
+#define HISTOGRAM_SUB_COUNT          (1u << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_OCTAVES            20u
+#define HISTOGRAM_SIZE               ((HISTOGRAM_OCTAVES + 1u) \
+                                      * HISTOGRAM_SUB_COUNT)
+
+#define PAGE_BUTTON_MASK             0x2    // T1 -> next page of results
+#define NR_OF_PERCENTILES            5u
+#define NR_OF_PAGES                  (NR_OF_PERCENTILES + 1u)
+#define PERCENTILE_P99               2u     // index into percentile_permille
+
+/* Sweep over load x priorities x priority grouping, started with T3 */
+#define SWEEP_BUTTON_MASK            0x8
+#define NR_OF_LOADS                  4u
+#define NR_OF_PRIORITY_PAIRS         5u
+#define NR_OF_GROUPINGS              5u
+#define NR_OF_SWEEP_RUNS             (NR_OF_LOADS * NR_OF_PRIORITY_PAIRS \
+                                      * NR_OF_GROUPINGS)
+
+#define SCB_AIRCR                    (*((volatile uint32_t *)(0xE000ED0C)))
+#define AIRCR_VECTKEY                (0x05FAu << 16)
+#define AIRCR_PRIGROUP_POS           8
+#define AIRCR_PRIGROUP_MASK          (0x7u << AIRCR_PRIGROUP_POS)
+#define IMPLEMENTED_PRIORITY_BITS    4u
+
+/* ITM stimulus port 0, shown by the debug (printf) viewer */
+#define ITM_STIM0                    (*((volatile uint32_t *)(0xE0000000)))
+#define ITM_STIM0_BYTE               (*((volatile uint8_t *)(0xE0000000)))
+#define ITM_TER                      (*((volatile uint32_t *)(0xE0000E00)))
+#define ITM_TCR                      (*((volatile uint32_t *)(0xE0000E80)))
+#define ITM_TCR_ITMENA               (0x1u << 0)
+#define ITM_LINE_LENGTH              100
+
+
+/* -- type definitions
+ * ------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t count[HISTOGRAM_SIZE];
+    uint32_t total;
+    uint32_t max;
+} histogram_t;
+
+typedef struct {
+    uint32_t latency_avg;
+    uint32_t latency_p99;
+    uint32_t latency_max;
+    uint32_t tisr_avg;
+    uint32_t tisr_p99;
+    uint32_t tisr_max;
+    uint32_t load;                  // timer3 interrupts during the run
+    hal_bool_t timeout;             // fewer TIM2 interrupts than required
+} sweep_result_t;
+
 
 /* -- function prototypes
  * ------------------------------------------------------------------------- */
@@ -36,9 +109,23 @@ void TIM3_IRQHandler(void);
 
 /* -- functions with module-wide scope
  * ------------------------------------------------------------------------- */
-static void print_results(void);
+static hal_bool_t run_measurement(uint16_t reload_value_tim3,
+                                  uint8_t priority_tim2,
+                                  uint8_t priority_tim3);
+static void run_sweep(void);
+static void print_sweep(void);
+static void print_sweep_matrix(uint8_t tisr);
+static void itm_write(const char *text);
+static void print_results(uint8_t page);
+static void print_percentile(uint8_t index);
+static void print_timeout(void);
 static uint8_t convert_uint32_t_to_string(char ret_val[], uint32_t value);
 static uint16_t read_hex_switch(void);
+static void calibrate_measurement(void);
+static void histogram_reset(histogram_t *histogram);
+static inline void histogram_add(histogram_t *histogram, uint32_t value);
+static uint32_t histogram_percentile(const histogram_t *histogram,
+                                     uint32_t permille);
 
 
 /* -- variables with module-wide scope
@@ -53,14 +140,56 @@ static uint32_t avg_latency = 0;
 static uint32_t sum_tisr = 0;       // time of interrupt service routine
 static uint32_t avg_tisr = 0;       // average time of interrupt service routine
 static volatile uint32_t dummy_counter;
+static uint32_t stamp_overhead = 0;         // see calibrate_measurement()
+static uint32_t count_delay = 0;            // see calibrate_measurement()
+static histogram_t latency_histogram;
+static histogram_t tisr_histogram;
+
+/* p50, p90, p99, p99.9 and max in 1/1000 */
+static const uint32_t percentile_permille[NR_OF_PERCENTILES] = {
+    500, 900, 990, 999, 1000
+};
+static const char percentile_label[NR_OF_PERCENTILES][6] = {
+    "p50", "p90", "p99", "p99.9", "max"
+};
+
+/* timer3 reload: no load, 10 kHz, 100 kHz and 1000 kHz as on the HEX switch */
+static const uint16_t sweep_reload[NR_OF_LOADS] = { 0, 8400, 840, 84 };
+static const char sweep_load_label[NR_OF_LOADS][9] = {
+    "none", "10 kHz", "100 kHz", "1000 kHz"
+};
+
+/* TIM2 / TIM3: equal, differing in the lowest or in the highest of the
+ * implemented priority bits, TIM2 higher and lower each */
+static const uint8_t sweep_priority[NR_OF_PRIORITY_PAIRS][2] = {
+    { 0x10, 0x10 }, { 0x00, 0x10 }, { 0x10, 0x00 }, { 0x00, 0x80 },
+    { 0x80, 0x00 }
+};
+
+/* PRIGROUP 3 .. 7: 4/0, 3/1, 2/2, 1/3 and 0/4 preemption/subpriority bits */
+static const uint8_t sweep_prigroup[NR_OF_GROUPINGS] = { 3, 4, 5, 6, 7 };
+
+static sweep_result_t sweep_results[NR_OF_GROUPINGS][NR_OF_PRIORITY_PAIRS]
+                                   [NR_OF_LOADS];
 
 /* -- M A I N
  * ------------------------------------------------------------------------- */
 
 int main(void)
 {
-    hal_timer_base_init_t timer_init;
     uint16_t reload_value_tim3;
+    uint8_t priority_tim2;
+    uint8_t priority_tim3;
+    hal_bool_t results_valid = FALSE;
+    uint8_t page = 0;
+    uint8_t page_button;
+    uint8_t previous_page_button = 0;
+    
+    /* start the DWT cycle counter and calibrate the measurement once */
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+    calibrate_measurement();
       
     while (1){
         
@@ -69,57 +198,30 @@ int main(void)
             
             /* dummy read to display the HEX switch position on SEG7 */
             read_hex_switch();
+
+            /* T1 pages through the percentiles of the last measurement */
+            page_button = CT_BUTTON & PAGE_BUTTON_MASK;
+            if (page_button && !previous_page_button && results_valid) {
+                page = (uint8_t)((page + 1u) % NR_OF_PAGES);
+                print_results(page);
+            }
+            previous_page_button = page_button;
+
+            /* T3: all loads x priorities x groupings, takes ~2 minutes */
+            if (CT_BUTTON & SWEEP_BUTTON_MASK) {
+                run_sweep();
+                print_sweep();
+                results_valid = FALSE;
+            }
         }
         
-        /* reset statistics */
-        measurement_done = FALSE;
-        tim3_interrupt_counter = 0;
-        tim2_interrupt_counter = 0;
-        min_latency = 100000;
-        max_latency = 0;
-        sum_latency = 0;
-        avg_latency = 0;
-        sum_tisr = 0;
-        avg_tisr = 0;
-        
-        /* init display, Use RED background while test is running */
-        hal_ct_lcd_clear();
-        hal_ct_lcd_color(HAL_LCD_RED, 0xffff);
-        hal_ct_lcd_color(HAL_LCD_BLUE, 0u);
-        hal_ct_lcd_color(HAL_LCD_GREEN, 0u);
-
-        /* init timer2 with a clock source frequency of 84MHz 
-           --> generate a timer2 interrupt every 1ms */
-        TIM2_ENABLE();
-        TIM2_RESET();
-
-        timer_init.mode = HAL_TIMER_MODE_UP;
-        timer_init.run_mode = HAL_TIMER_RUN_CONTINOUS;
-        timer_init.prescaler = 0u;
-        timer_init.count = RELOAD_VALUE_TIM2;     //counter overflow every 1ms
-        
-        hal_timer_init_base(TIM2, timer_init);
-        hal_timer_irq_set(TIM2, HAL_TIMER_IRQ_UE, ENABLE);
-
         /* read and display the amount of load selected for timer 3*/
         reload_value_tim3 = read_hex_switch();
-        
-        /* init timer3 with a clock source frequency of 84MHz */
-        TIM3_ENABLE();
-        TIM3_RESET();
-
-        timer_init.mode = HAL_TIMER_MODE_UP;
-        timer_init.run_mode = HAL_TIMER_RUN_CONTINOUS;
-        timer_init.prescaler = 0u;
-        timer_init.count = reload_value_tim3;  // from hex switch
-        
-        hal_timer_init_base(TIM3, timer_init);
-        hal_timer_irq_set(TIM3, HAL_TIMER_IRQ_UE, ENABLE);
 
         /* set default interrupt priorities: 
                 load on both timers set to same priority   */
-        NVIC->IP[IRQNUM_TIM2] = 0x10;      //set priority level of timer2 to 1
-        NVIC->IP[IRQNUM_TIM3] = 0x10;      //set priority level of timer3 to 1
+        priority_tim2 = 0x10;      //set priority level of timer2 to 1
+        priority_tim3 = 0x10;      //set priority level of timer3 to 1
 
 
         /* Set interrupt priorities based on dip switches 
@@ -137,40 +239,301 @@ int main(void)
 
         /// STUDENTS: To be programmed
 
-
-
+        priority_tim3 = CT_DIPSW->BYTE.S7_0 & 0xF0;
+        priority_tim2 = CT_DIPSW->BYTE.S15_8 & 0xF0;
 
         /// END: To be programmed
 
-        /* start timer2 */
-        hal_timer_start(TIM2);
-        
-        /* if there is load --> start timer 3 */
-        if (reload_value_tim3 != 0) {
-            hal_timer_start(TIM3);
-        }
-        
-        /* wait for measurement to finish */
-        while(!measurement_done){
+        if (!run_measurement(reload_value_tim3, priority_tim2,
+                             priority_tim3)) {
+            print_timeout();
+            results_valid = FALSE;
+            continue;
         }
         
         /* print out measurement */
+        page = 0;
+        print_results(page);
+        results_valid = TRUE;
+
+    }
+}
+
+/**
+ * \brief  Runs one measurement of NUMBER_OF_TIMER_2_INTERRUPTS interrupts
+ *         with the given load on timer3 and the given NVIC priorities
+ * \param  reload_value_tim3: from read_hex_switch(), 0 --> no load
+ * \return FALSE if the measurement did not finish within
+ *         MEASUREMENT_TIMEOUT_CYCLES, the timers are stopped then and the
+ *         statistics cover the interrupts counted so far
+ */
+static hal_bool_t run_measurement(uint16_t reload_value_tim3,
+                                  uint8_t priority_tim2,
+                                  uint8_t priority_tim3)
+{
+    hal_timer_base_init_t timer_init;
+    hal_bool_t done;
+    uint32_t start;
+
+    /* reset statistics */
+    measurement_done = FALSE;
+    tim3_interrupt_counter = 0;
+    tim2_interrupt_counter = 0;
+    min_latency = 100000;
+    max_latency = 0;
+    sum_latency = 0;
+    avg_latency = 0;
+    sum_tisr = 0;
+    avg_tisr = 0;
+    histogram_reset(&latency_histogram);
+    histogram_reset(&tisr_histogram);
+    
+    /* init display, Use RED background while test is running */
+    hal_ct_lcd_clear();
+    hal_ct_lcd_color(HAL_LCD_RED, 0xffff);
+    hal_ct_lcd_color(HAL_LCD_BLUE, 0u);
+    hal_ct_lcd_color(HAL_LCD_GREEN, 0u);
+
+    /* init timer2 with a clock source frequency of 84MHz 
+       --> generate a timer2 interrupt every 1ms */
+    TIM2_ENABLE();
+    TIM2_RESET();
+
+    timer_init.mode = HAL_TIMER_MODE_UP;
+    timer_init.run_mode = HAL_TIMER_RUN_CONTINOUS;
+    timer_init.prescaler = 0u;
+    timer_init.count = RELOAD_VALUE_TIM2;     //counter overflow every 1ms
+    
+    hal_timer_init_base(TIM2, timer_init);
+    hal_timer_irq_set(TIM2, HAL_TIMER_IRQ_UE, ENABLE);
+
+    /* init timer3 with a clock source frequency of 84MHz */
+    TIM3_ENABLE();
+    TIM3_RESET();
+
+    timer_init.mode = HAL_TIMER_MODE_UP;
+    timer_init.run_mode = HAL_TIMER_RUN_CONTINOUS;
+    timer_init.prescaler = 0u;
+    timer_init.count = reload_value_tim3;
+    
+    hal_timer_init_base(TIM3, timer_init);
+    hal_timer_irq_set(TIM3, HAL_TIMER_IRQ_UE, ENABLE);
+
+    NVIC->IP[IRQNUM_TIM2] = priority_tim2;
+    NVIC->IP[IRQNUM_TIM3] = priority_tim3;
+
+    /* start timer2 */
+    start = DWT_CYCCNT;
+    hal_timer_start(TIM2);
+    
+    /* if there is load --> start timer 3 */
+    if (reload_value_tim3 != 0) {
+        hal_timer_start(TIM3);
+    }
+    
+    /* wait for measurement to finish */
+    while (!measurement_done
+           && DWT_CYCCNT - start < MEASUREMENT_TIMEOUT_CYCLES) {
+    }
+    done = measurement_done;
+    if (!done) {
+        hal_timer_stop(TIM2);
+        hal_timer_stop(TIM3);
+        hal_timer_irq_clear(TIM2, HAL_TIMER_IRQ_UE);
+        hal_timer_irq_clear(TIM3, HAL_TIMER_IRQ_UE);
+    }
+    
+    if (tim2_interrupt_counter != 0) {
         avg_latency = sum_latency / tim2_interrupt_counter;
         avg_tisr = sum_tisr / tim2_interrupt_counter;
-        print_results();
+    }
+    return done;
+}
 
+
+/**
+ * \brief  Measures every load x priority pair x priority grouping and stores
+ *         the results in sweep_results. The grouping in SCB->AIRCR is
+ *         restored at the end.
+ */
+static void run_sweep(void)
+{
+    uint32_t aircr = SCB_AIRCR;
+    uint32_t group;
+    uint32_t pair;
+    uint32_t load;
+    uint32_t run = 0;
+    uint32_t preemption_bits;
+    sweep_result_t *result;
+    char line[21];
+
+    for (group = 0; group < NR_OF_GROUPINGS; group++) {
+        /* only PRIGROUP is written, a 1 in the other bits would reset */
+        SCB_AIRCR = AIRCR_VECTKEY
+                    | ((uint32_t)sweep_prigroup[group] << AIRCR_PRIGROUP_POS);
+        preemption_bits = 7u - sweep_prigroup[group];
+
+        for (pair = 0; pair < NR_OF_PRIORITY_PAIRS; pair++) {
+            for (load = 0; load < NR_OF_LOADS; load++) {
+                result = &sweep_results[group][pair][load];
+                result->timeout = !run_measurement(sweep_reload[load],
+                                                   sweep_priority[pair][0],
+                                                   sweep_priority[pair][1]);
+                result->latency_avg = avg_latency;
+                result->latency_p99 = histogram_percentile(
+                    &latency_histogram, percentile_permille[PERCENTILE_P99]);
+                result->latency_max = max_latency;
+                result->tisr_avg = avg_tisr;
+                result->tisr_p99 = histogram_percentile(
+                    &tisr_histogram, percentile_permille[PERCENTILE_P99]);
+                result->tisr_max = tisr_histogram.max;
+                result->load = tim3_interrupt_counter;
+
+                /* "sweep  37/100       " "3/1 00/80 1000 kHz  " */
+                run++;
+                (void)snprintf(line, sizeof(line), "sweep %3u/%3u",
+                               (unsigned)run, (unsigned)NR_OF_SWEEP_RUNS);
+                hal_ct_lcd_write(0, line);
+                (void)snprintf(line, sizeof(line), "%u/%u %02X/%02X %s",
+                               (unsigned)preemption_bits,
+                               (unsigned)(IMPLEMENTED_PRIORITY_BITS
+                                          - preemption_bits),
+                               (unsigned)sweep_priority[pair][0],
+                               (unsigned)sweep_priority[pair][1],
+                               sweep_load_label[load]);
+                hal_ct_lcd_write(20, line);
+            }
+        }
+    }
+    SCB_AIRCR = AIRCR_VECTKEY | (aircr & AIRCR_PRIGROUP_MASK);
+}
+
+
+/**
+ * \brief  Prints the sweep as two matrices to ITM port 0, one for latency and
+ *         one for service time, then reports the end on the LCD
+ */
+static void print_sweep(void)
+{
+    print_sweep_matrix(0);
+    print_sweep_matrix(1);
+
+    hal_ct_lcd_color(HAL_LCD_RED, 0u);
+    hal_ct_lcd_color(HAL_LCD_GREEN, 0xffff);
+    hal_ct_lcd_clear();
+    hal_ct_lcd_write(0, "sweep done");
+    hal_ct_lcd_write(20, "matrix on ITM port 0");
+}
+
+
+/**
+ * \brief  One row per grouping and priority pair, one column per load, e.g.
+ *   TIM2 latency [cycles] avg/p99/max, TIM3 interrupts
+ *   grp  TIM2 TIM3 |                       none |                     10 kHz
+ *   4/0  0x10 0x10 |   24/   25/    31       0 |   25/   31/    40    9989
+ * A run that timed out shows "timeout" and the TIM3 interrupts until then.
+ * \param  tisr: 0 --> latency, otherwise service time
+ */
+static void print_sweep_matrix(uint8_t tisr)
+{
+    char line[ITM_LINE_LENGTH];
+    const sweep_result_t *result;
+    uint32_t group;
+    uint32_t pair;
+    uint32_t load;
+    uint32_t preemption_bits;
+
+    itm_write(tisr ? "\r\nTIM2 service time [cycles] avg/p99/max, TIM3 "
+                     "interrupts\r\n"
+                   : "\r\nTIM2 latency [cycles] avg/p99/max, TIM3 "
+                     "interrupts\r\n");
+    itm_write("grp  TIM2 TIM3");
+    for (load = 0; load < NR_OF_LOADS; load++) {
+        (void)snprintf(line, sizeof(line), " |%26s", sweep_load_label[load]);
+        itm_write(line);
+    }
+    itm_write("\r\n");
+
+    for (group = 0; group < NR_OF_GROUPINGS; group++) {
+        preemption_bits = 7u - sweep_prigroup[group];
+        for (pair = 0; pair < NR_OF_PRIORITY_PAIRS; pair++) {
+            (void)snprintf(line, sizeof(line), "%u/%u  0x%02X 0x%02X",
+                           (unsigned)preemption_bits,
+                           (unsigned)(IMPLEMENTED_PRIORITY_BITS
+                                      - preemption_bits),
+                           (unsigned)sweep_priority[pair][0],
+                           (unsigned)sweep_priority[pair][1]);
+            itm_write(line);
+            for (load = 0; load < NR_OF_LOADS; load++) {
+                result = &sweep_results[group][pair][load];
+                if (result->timeout) {
+                    (void)snprintf(line, sizeof(line), " |%18s %7u",
+                                   "timeout", (unsigned)result->load);
+                    itm_write(line);
+                    continue;
+                }
+                (void)snprintf(line, sizeof(line), " |%5u/%5u/%6u %7u",
+                               (unsigned)(tisr ? result->tisr_avg
+                                               : result->latency_avg),
+                               (unsigned)(tisr ? result->tisr_p99
+                                               : result->latency_p99),
+                               (unsigned)(tisr ? result->tisr_max
+                                               : result->latency_max),
+                               (unsigned)result->load);
+                itm_write(line);
+            }
+            itm_write("\r\n");
+        }
     }
 }
 
 /**
  * \brief   Timer 2 ISR: Measuring Interrupt latency and Interrupt Service Time
+ *
+ * The DWT stamp is taken first, TIM2->CNT right after it. The counter runs
+ * at the CPU clock, so the update event happened 'elapsed' cycles before
+ * CNT was sampled and 'elapsed - count_delay' cycles before the stamp.
+ * The service time is measured from the stamp to the end of the ISR.
  */
 void TIM2_IRQHandler(void)
 {
     /// STUDENTS: To be programmed
 
+    uint32_t entry = DWT_CYCCNT;
+    uint32_t count = TIM2->CNT;
+    uint32_t elapsed;
+    uint32_t update;
+    uint32_t latency;
+    uint32_t tisr;
+
+    /* ticks since the update event, counting down the event is at 0 */
+    if (TIM2->CR1 & TIM_CR1_DIR) {
+        elapsed = TIM2->ARR - count;
+    } else {
+        elapsed = count;
+    }
+    update = entry + count_delay - elapsed * CYCLES_PER_TIM2_TICK;
+    latency = entry - update;
 
+    hal_timer_irq_clear(TIM2, HAL_TIMER_IRQ_UE);
+    tim2_interrupt_counter++;
+    if (latency < min_latency) {
+        min_latency = latency;
+    }
+    if (latency > max_latency) {
+        max_latency = latency;
+    }
+    sum_latency += latency;
+    histogram_add(&latency_histogram, latency);
 
+    if (tim2_interrupt_counter >= NUMBER_OF_TIMER_2_INTERRUPTS) {
+        hal_timer_stop(TIM2);
+        hal_timer_stop(TIM3);
+        measurement_done = TRUE;    // main() only runs after the return
+    }
+    tisr = DWT_CYCCNT - entry - stamp_overhead;
+    sum_tisr += tisr;
+    histogram_add(&tisr_histogram, tisr);
 
     /// END: To be programmed
 }
@@ -195,8 +558,10 @@ void TIM3_IRQHandler(void)
 /**
  * \brief  Prints the minimal, maximal and average interrupt latency and the 
  *         number of occured timer3 interrupts to the display
+ * \param  page: 0 for this summary, 1 .. NR_OF_PERCENTILES for one
+ *               percentile of latency and service time each
  */
-static void print_results(void)
+static void print_results(uint8_t page)
 {
   
     char label_min[] = "min ";
@@ -211,6 +576,12 @@ static void print_results(void)
     // set lcd backlight green
     hal_ct_lcd_color(HAL_LCD_RED, 0u);
     hal_ct_lcd_color(HAL_LCD_GREEN, 0xffff);
+    hal_ct_lcd_clear();
+
+    if (page != 0) {
+        print_percentile(page - 1u);
+        return;
+    }
 
     // write label "min"
     hal_ct_lcd_write(pos, label_min);
@@ -224,10 +595,240 @@ static void print_results(void)
     
     /// STUDENTS: To be programmed
 
+    /* "min 21    max 57   " */
+    pos += (uint8_t)(sizeof(label_min) - 1u);
+    (void)convert_uint32_t_to_string(ret_val, min_latency);
+    hal_ct_lcd_write(pos, ret_val);
+    pos = 10;
+    hal_ct_lcd_write(pos, label_max);
+    pos += (uint8_t)(sizeof(label_max) - 1u);
+    (void)convert_uint32_t_to_string(ret_val, max_latency);
+    hal_ct_lcd_write(pos, ret_val);
+
+    /* "avg 24/61  load 9999" latency / service time */
+    pos = 20;
+    hal_ct_lcd_write(pos, label_avg);
+    pos += (uint8_t)(sizeof(label_avg) - 1u);
+    length = convert_uint32_t_to_string(ret_val, avg_latency);
+    hal_ct_lcd_write(pos, ret_val);
+    pos += length;
+    hal_ct_lcd_write(pos, "/");
+    pos += 1u;
+    length = convert_uint32_t_to_string(ret_val, avg_tisr);
+    hal_ct_lcd_write(pos, ret_val);
+    pos += length;
+
+    /* load count right aligned, the label only if there is room */
+    length = convert_uint32_t_to_string(ret_val, tim3_interrupt_counter);
+    if (pos + sizeof(label_load) + length <= 40u) {
+        hal_ct_lcd_write((uint8_t)(40u - length - (sizeof(label_load) - 1u)),
+                         label_load);
+    }
+    hal_ct_lcd_write((uint8_t)(40u - length), ret_val);
 
+    /// END: To be programmed
+}
 
 
-    /// END: To be programmed
+/**
+ * \brief  Prints one percentile of latency and service time in cycles, e.g.
+ *           "p99.9  lat    57 cyc"
+ *           "       isr    61 cyc"
+ * \param  index: into percentile_permille
+ */
+static void print_percentile(uint8_t index)
+{
+    char line[21];
+
+    (void)snprintf(line, sizeof(line), "%-6s lat%6u cyc",
+                   percentile_label[index],
+                   (unsigned)histogram_percentile(&latency_histogram,
+                                                  percentile_permille[index]));
+    hal_ct_lcd_write(0, line);
+    (void)snprintf(line, sizeof(line), "       isr%6u cyc",
+                   (unsigned)histogram_percentile(&tisr_histogram,
+                                                  percentile_permille[index]));
+    hal_ct_lcd_write(20, line);
+}
+
+
+/**
+ * \brief  Reports a measurement that timed out, e.g.
+ *           "timeout             "
+ *           "TIM2 irq  412/1000  "
+ */
+static void print_timeout(void)
+{
+    char line[21];
+
+    hal_ct_lcd_color(HAL_LCD_RED, 0xffff);
+    hal_ct_lcd_color(HAL_LCD_GREEN, 0u);
+    hal_ct_lcd_clear();
+    hal_ct_lcd_write(0, "timeout");
+    (void)snprintf(line, sizeof(line), "TIM2 irq %4u/%u",
+                   (unsigned)tim2_interrupt_counter,
+                   (unsigned)NUMBER_OF_TIMER_2_INTERRUPTS);
+    hal_ct_lcd_write(20, line);
+}
+
+
+/**
+ * \brief  Empties the histogram
+ */
+static void histogram_reset(histogram_t *histogram)
+{
+    uint32_t i;
+
+    for (i = 0; i < HISTOGRAM_SIZE; i++) {
+        histogram->count[i] = 0;
+    }
+    histogram->total = 0;
+    histogram->max = 0;
+}
+
+
+/**
+ * \brief  Counts 'value' in O(1) and without division, called from the ISR.
+ *         For value >= 2^SUB_BITS the octave follows from the position of
+ *         the leading one, the bucket in the octave from the SUB_BITS bits
+ *         below it.
+ */
+static inline void histogram_add(histogram_t *histogram, uint32_t value)
+{
+    uint32_t octave;
+    uint32_t bucket;
+
+    if (value < HISTOGRAM_SUB_COUNT) {
+        bucket = value;
+    } else {
+        octave = 32u - HISTOGRAM_SUB_BITS - __clz(value);
+        if (octave > HISTOGRAM_OCTAVES) {
+            bucket = HISTOGRAM_SIZE - 1u;
+        } else {
+            bucket = (octave << HISTOGRAM_SUB_BITS)
+                     + ((value >> (octave - 1u)) & (HISTOGRAM_SUB_COUNT - 1u));
+        }
+    }
+    histogram->count[bucket]++;
+    histogram->total++;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+
+/**
+ * \brief  Smallest value that at least 'permille' / 1000 of the counted
+ *         values do not exceed. Reports the upper end of the bucket, but
+ *         never more than the exact maximum.
+ * \return value, 0 if the histogram is empty
+ */
+static uint32_t histogram_percentile(const histogram_t *histogram,
+                                     uint32_t permille)
+{
+    uint32_t rank = (histogram->total * permille + 999u) / 1000u;
+    uint32_t seen = 0;
+    uint32_t bucket;
+    uint32_t octave;
+    uint32_t upper;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (bucket = 0; bucket < HISTOGRAM_SIZE; bucket++) {
+        seen += histogram->count[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    if (bucket >= HISTOGRAM_SIZE - 1u) {
+        return histogram->max;
+    }
+
+    octave = bucket >> HISTOGRAM_SUB_BITS;
+    if (octave == 0) {
+        upper = bucket;
+    } else {
+        /* the next bucket starts at (SUB_COUNT + sub + 1) * 2^(octave - 1) */
+        upper = ((HISTOGRAM_SUB_COUNT + (bucket & (HISTOGRAM_SUB_COUNT - 1u))
+                  + 1u) << (octave - 1u)) - 1u;
+    }
+    return (upper < histogram->max) ? upper : histogram->max;
+}
+
+
+/**
+ * \brief  Calibrates the two corrections of TIM2_IRQHandler(), smallest of
+ *         CALIBRATION_RUNS runs each:
+ *         - stamp_overhead: back to back DWT_CYCCNT reads, the time the
+ *           closing stamp adds to the service time.
+ *         - count_delay: time from the entry stamp to the sampling of
+ *           TIM2->CNT. The sequence of the ISR (stamp, TIM2->CNT) runs with
+ *           TIM2 counting and is bracketed by a second stamp. The APB1 read
+ *           is taken to sample CNT at its end, one stamp before the second
+ *           one. If the bridge samples earlier, the latency comes out too
+ *           low by the cycles the data takes back to the core (known bias,
+ *           a few cycles).
+ */
+static void calibrate_measurement(void)
+{
+    hal_timer_base_init_t timer_init;
+    uint32_t first;
+    uint32_t second;
+    uint32_t bracket = 0xFFFFFFFFu;
+    uint32_t run;
+    volatile uint32_t count;
+
+    stamp_overhead = 0xFFFFFFFFu;
+    for (run = 0; run < CALIBRATION_RUNS; run++) {
+        first = DWT_CYCCNT;
+        second = DWT_CYCCNT;
+        if (second - first < stamp_overhead) {
+            stamp_overhead = second - first;
+        }
+    }
+
+    /* TIM2 free-running as in run_measurement(), interrupt not enabled */
+    TIM2_ENABLE();
+    TIM2_RESET();
+    timer_init.mode = HAL_TIMER_MODE_UP;
+    timer_init.run_mode = HAL_TIMER_RUN_CONTINOUS;
+    timer_init.prescaler = 0u;
+    timer_init.count = RELOAD_VALUE_TIM2;
+    hal_timer_init_base(TIM2, timer_init);
+    hal_timer_start(TIM2);
+
+    for (run = 0; run < CALIBRATION_RUNS; run++) {
+        first = DWT_CYCCNT;
+        count = TIM2->CNT;
+        second = DWT_CYCCNT;
+        if (second - first < bracket) {
+            bracket = second - first;
+        }
+    }
+    (void)count;
+    hal_timer_stop(TIM2);
+
+    count_delay = bracket - stamp_overhead;
+}
+
+
+/**
+ * \brief  Writes 'text' to ITM stimulus port 0. Does nothing unless a
+ *         debugger enabled the ITM and the port, so the sweep also runs
+ *         without one.
+ */
+static void itm_write(const char *text)
+{
+    if (!(ITM_TCR & ITM_TCR_ITMENA) || !(ITM_TER & 0x1u)) {
+        return;
+    }
+    while (*text != '\0') {
+        while (ITM_STIM0 == 0) {
+            /* wait until the FIFO accepts the next byte */
+        }
+        ITM_STIM0_BYTE = (uint8_t)*text++;
+    }
 }
 
 
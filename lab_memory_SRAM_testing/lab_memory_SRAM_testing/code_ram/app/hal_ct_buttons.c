@@ -24,9 +24,66 @@
 /* macros visible only inside of module */
 #define BUTTON_REG     (*((volatile uint8_t *)(0x60000210)))
 #define BUTTON_T0_MASK 0x01
+#define NR_OF_BUTTONS  4u
+
+/* SysTick, clocked with HCLK = 84 MHz */
+#define SYST_CSR       (*((volatile uint32_t *)(0xE000E010)))
+#define SYST_RVR       (*((volatile uint32_t *)(0xE000E014)))
+#define SYST_CVR       (*((volatile uint32_t *)(0xE000E018)))
+#define SYST_CSR_RUN   0x7          // enable, interrupt, processor clock
+#define HCLK_PER_MS    84000u
+
+#define LONG_TICKS     (HAL_CT_BUTTON_LONG_MS / HAL_CT_BUTTON_SAMPLE_MS)
+#define REPEAT_TICKS   (HAL_CT_BUTTON_REPEAT_MS / HAL_CT_BUTTON_SAMPLE_MS)
+#define QUEUE_MASK     (HAL_CT_BUTTON_QUEUE_SIZE - 1u)
+
+/* variables visible within the whole module */
+
+// debounced state and the previous raw sample of the buttons
+static uint8_t debounced_state = 0;
+static uint8_t previous_sample = 0;
+
+// number of samples each button has been held down
+static uint16_t held_ticks[NR_OF_BUTTONS];
+
+// set by the isr on a press, cleared by hal_ct_button_is_pressed()
+static volatile uint8_t press_latched[NR_OF_BUTTONS];
+
+// event queue: written by the isr only at 'head', read by main at 'tail'
+static hal_ct_button_event_t queue[HAL_CT_BUTTON_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+
+/* local function declarations */
+static void queue_put(hal_ct_button_t button, hal_ct_button_event_type_t type);
 
 /* function definitions */
 
+/*
+ * see header file
+ */
+void hal_ct_button_init(void)
+{
+    SYST_RVR = HAL_CT_BUTTON_SAMPLE_MS * HCLK_PER_MS - 1u;
+    SYST_CVR = 0u;
+    SYST_CSR = SYST_CSR_RUN;
+}
+
+/*
+ * see header file
+ */
+uint32_t hal_ct_button_get_event(hal_ct_button_event_t *event)
+{
+    uint8_t tail = queue_tail;
+
+    if (tail == queue_head) {
+        return false;
+    }
+    *event = queue[tail];
+    queue_tail = (uint8_t)((tail + 1u) & QUEUE_MASK);
+    return true;
+}
+
 /*
  * see header file
  */
@@ -34,9 +91,65 @@ uint32_t hal_ct_button_is_pressed(hal_ct_button_t button)
 {
     uint32_t ret_value = false;
 
-    // if button is pressed, wait until button is not pressed anymore
-    while ((BUTTON_REG & (BUTTON_T0_MASK << button))) {
+    if (press_latched[button]) {
+        press_latched[button] = false;
         ret_value = true;
     }
     return ret_value;
-}
\ No newline at end of file
+}
+
+/*
+ * see header file
+ * A button changes its debounced state only after two equal samples,
+ * i.e. bouncing shorter than HAL_CT_BUTTON_SAMPLE_MS is ignored.
+ */
+void SysTick_Handler(void)
+{
+    uint8_t sample = BUTTON_REG;
+    uint8_t stable = (uint8_t)~(sample ^ previous_sample);
+    uint8_t new_state = (debounced_state & ~stable) | (sample & stable);
+    uint8_t pressed = new_state & ~debounced_state;
+    uint8_t released = debounced_state & ~new_state;
+    uint8_t mask;
+    uint8_t i;
+
+    previous_sample = sample;
+    debounced_state = new_state;
+
+    for (i = 0; i < NR_OF_BUTTONS; i++) {
+        mask = (uint8_t)(BUTTON_T0_MASK << i);
+        if (pressed & mask) {
+            held_ticks[i] = 0;
+            press_latched[i] = true;
+            queue_put((hal_ct_button_t)i, HAL_CT_BUTTON_PRESS);
+        } else if (released & mask) {
+            queue_put((hal_ct_button_t)i, HAL_CT_BUTTON_RELEASE);
+        } else if (new_state & mask) {
+            held_ticks[i]++;
+            if (held_ticks[i] == LONG_TICKS) {
+                queue_put((hal_ct_button_t)i, HAL_CT_BUTTON_LONG_PRESS);
+            } else if (held_ticks[i] == LONG_TICKS + REPEAT_TICKS) {
+                queue_put((hal_ct_button_t)i, HAL_CT_BUTTON_REPEAT);
+                held_ticks[i] = LONG_TICKS;
+            }
+        }
+    }
+}
+
+/* local function definitions */
+
+/*
+ * Appends an event to the queue, drops it if the queue is full
+ */
+static void queue_put(hal_ct_button_t button, hal_ct_button_event_type_t type)
+{
+    uint8_t head = queue_head;
+    uint8_t next = (uint8_t)((head + 1u) & QUEUE_MASK);
+
+    if (next == queue_tail) {
+        return;
+    }
+    queue[head].button = button;
+    queue[head].type = type;
+    queue_head = next;
+}
@@ -30,11 +30,48 @@ typedef enum {
     HAL_CT_BUTTON_T3 = 0x03
 }hal_ct_button_t;
 
+typedef enum {
+    HAL_CT_BUTTON_PRESS,        // debounced press
+    HAL_CT_BUTTON_RELEASE,      // debounced release
+    HAL_CT_BUTTON_LONG_PRESS,   // held for HAL_CT_BUTTON_LONG_MS
+    HAL_CT_BUTTON_REPEAT        // held further, every HAL_CT_BUTTON_REPEAT_MS
+}hal_ct_button_event_type_t;
+
+typedef struct {
+    hal_ct_button_t button;
+    hal_ct_button_event_type_t type;
+}hal_ct_button_event_t;
+
+/* macros visible outside of module */
+#define HAL_CT_BUTTON_SAMPLE_MS     10u
+#define HAL_CT_BUTTON_LONG_MS     1000u
+#define HAL_CT_BUTTON_REPEAT_MS    200u
+#define HAL_CT_BUTTON_QUEUE_SIZE    16u     // power of 2
+
 /* function declarations */
 
 /*
- * Returns 'true' if the specified 'button'is pressed, 'false' otherwise
- * If pressed the function waits for the release of the button
+ * Starts sampling the buttons every HAL_CT_BUTTON_SAMPLE_MS in the SysTick
+ * interrupt. The samples are debounced and turned into events.
+ */
+void hal_ct_button_init(void);
+
+/*
+ * Returns 'true' and copies the oldest pending event to 'event' if there
+ * is one, 'false' otherwise. The function never waits.
+ * The queue holds up to HAL_CT_BUTTON_QUEUE_SIZE - 1 events, further
+ * events are dropped until main has fetched some of them.
+ */
+uint32_t hal_ct_button_get_event(hal_ct_button_event_t *event);
+
+/*
+ * Returns 'true' if the specified 'button' has been pressed since the last
+ * call, 'false' otherwise. The function never waits.
  */
 uint32_t hal_ct_button_is_pressed(hal_ct_button_t button);
+
+/*
+ * Interrupt service routine sampling the buttons
+ */
+void SysTick_Handler(void);
 #endif
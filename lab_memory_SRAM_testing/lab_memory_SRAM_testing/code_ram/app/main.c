@@ -33,14 +33,26 @@
 
 #define SRAM_BASE_ADDR  0x64000000
 
+#define MAX_NR_OF_DEVICE_ERRORS 16
+
+static uint32_t device_errors[MAX_NR_OF_DEVICE_ERRORS];
+static uint32_t nr_of_device_errors = 0;
+
 void show_addr_error(uint16_t addr){
 	if (addr == 0x0000) addr = 0xF000;
 	CT_LED->HWORD.LED31_16 |= addr;
 }
 
+/*
+ * Shows the failing address and records it without waiting for the user,
+ * the recorded addresses can be browsed with T0 after the test.
+ */
 void show_device_error(uint32_t adr){
 	CT_SEG7->BIN.HWORD = adr;
-	while (!hal_ct_button_is_pressed(HAL_CT_BUTTON_T0)) {}
+	if (nr_of_device_errors < MAX_NR_OF_DEVICE_ERRORS) {
+		device_errors[nr_of_device_errors] = adr;
+	}
+	nr_of_device_errors++;
 }
 /// END: To be programmed
 
@@ -59,7 +71,11 @@ int main(void)
 	
 		uint16_t test_address = (uint16_t) 0x01 << NR_OF_ADDRESS_LINES;
 	
+		hal_ct_button_event_t event;
+		uint32_t error_index = 0;
+	
 		CT_LED->WORD = 0x00000000;
+		hal_ct_button_init();
 
 
 
@@ -163,12 +179,16 @@ int main(void)
      *
      * (2) First test: Read back each location and check pattern.
      *     In case of error, write address with wrong data to 7-segment and
-     *     wait for press on button T0.
+     *     record it, the test keeps running.
      *     Bitwise invert  the pattern in each location for the second test
      *
      * (3) Second test: Read back each location and check for new pattern.
      *     In case of error, write address with wrong data to 7-segment and
-     *     wait for press on button T0.
+     *     record it, the test keeps running.
+     *
+     * After the test the recorded addresses (the first
+     * MAX_NR_OF_DEVICE_ERRORS) are browsed with the press and repeat
+     * events of T0 from the event based button driver.
      */
     /// STUDENTS: To be programmed
 		
@@ -204,7 +224,20 @@ int main(void)
     CT_SEG7->RAW.BYTE.DS2 = 0x86;
     CT_SEG7->RAW.BYTE.DS3 = 0xFF;
     
+    /* T0 steps through the recorded device errors, holding it scrolls */
     while(1){
+        if (hal_ct_button_get_event(&event)
+                && event.button == HAL_CT_BUTTON_T0
+                && event.type != HAL_CT_BUTTON_RELEASE
+                && event.type != HAL_CT_BUTTON_LONG_PRESS
+                && nr_of_device_errors > 0) {
+            CT_SEG7->BIN.HWORD = device_errors[error_index];
+            error_index++;
+            if (error_index >= nr_of_device_errors
+                    || error_index >= MAX_NR_OF_DEVICE_ERRORS) {
+                error_index = 0;
+            }
+        }
     }
 
 }
\ No newline at end of file